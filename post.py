@@ -20,3 +20,13 @@ env.AddPostAction(
         "$BUILD_DIR/${PROGNAME}.elf", ">", "$BUILD_DIR/${PROGNAME}.lst"
     ]), "Building $BUILD_DIR/${PROGNAME}.lst")
 )
+
+# Deferred log format strings (MY_DLOG_ENABLE builds), for tools/dlog_decode.py --table
+env.AddPostAction(
+    "$BUILD_DIR/${PROGNAME}.elf",
+    env.VerboseAction(" ".join([
+        "~/.platformio/packages/toolchain-riscv/bin/riscv-none-elf-objcopy", "-O", "binary",
+        "--only-section=.dlog_fmt", "--set-section-flags", ".dlog_fmt=alloc,load,contents",
+        "$BUILD_DIR/${PROGNAME}.elf", "$BUILD_DIR/${PROGNAME}.dlog"
+    ]), "Extracting $BUILD_DIR/${PROGNAME}.dlog")
+)
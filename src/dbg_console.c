@@ -3,6 +3,15 @@
 #include "my_hal.h"
 #include "main.h"
 #include "nvs.h"
+#include "my_sched.h"
+#include "my_perf.h"
+#include "my_trace.h"
+#include "my_ctrl.h"
+#include "my_idle.h"
+#include "my_telem.h"
+#include "my_parse.h"
+#include "my_mem.h"
+#include "my_stack.h"
 
 #include <mik32_hal_eeprom.h>
 #include <stdio.h>
@@ -16,6 +25,14 @@ uint8_t cli_reset(int argc, char *argv[]);
 uint8_t dbg_device_info(int argc, char** argv);
 uint8_t dbg_enable_jtag(int argc, char** argv);
 uint8_t dbg_report(int argc, char** argv);
+uint8_t dbg_sched_report(int argc, char** argv);
+uint8_t dbg_perf_report(int argc, char** argv);
+uint8_t dbg_trace_dump(int argc, char** argv);
+uint8_t dbg_irq_stats(int argc, char** argv);
+uint8_t dbg_ctrl_report(int argc, char** argv);
+uint8_t dbg_load_report(int argc, char** argv);
+uint8_t dbg_uart_report(int argc, char** argv);
+uint8_t dbg_telem(int argc, char** argv);
 
 uint8_t dbg_hw_report(int argc, char** argv);
 uint8_t dbg_coproc_report(int argc, char** argv);
@@ -27,11 +44,11 @@ uint8_t dbg_nvs_report(int argc, char** argv);
 uint8_t dbg_nvs_test(int argc, char** argv);
 uint8_t dbg_nvs_dump(int argc, char** argv);
 uint8_t dbg_nvs_print_errors(int argc, char** argv);
-
-uint8_t dbg_set_kp(int argc, char** argv);
-uint8_t dbg_set_ki(int argc, char** argv);
-uint8_t dbg_set_target_jog_speed(int argc, char** argv);
-uint8_t dbg_set_encoder_coef(int argc, char** argv);
+uint8_t dbg_nvs_list(int argc, char** argv);
+uint8_t dbg_nvs_get(int argc, char** argv);
+uint8_t dbg_nvs_set(int argc, char** argv);
+uint8_t dbg_nvs_macro(int argc, char** argv);
+uint8_t dbg_mem_report(int argc, char** argv);
 
 uint8_t dbg_measure_adc_channel_directly(int argc, char** argv);
 uint8_t dbg_measure_adc_channels(int argc, char** argv);
@@ -39,38 +56,129 @@ uint8_t dbg_motor_run(int argc, char** argv);
 uint8_t dbg_stop(int argc, char** argv);
 uint8_t dbg_motion_debug(int argc, char** argv);
 
+/***
+ * Command table, kept sorted by name (binary-searched, cli_init() complains otherwise)
+ */
+
+const COMMAND_S cli_static_commands[] = {
+    CLI_COMMAND("ctrl", "Report control tick period, jitter and overruns, \"ctrl reset\" clears the stats", dbg_ctrl_report),
+    CLI_COMMAND_BUDGET("dbg_report", "Report debugging info", dbg_report, 1000),
+    CLI_COMMAND("err_store_report", "Print the contents of error memory", dbg_nvs_print_errors),
+    CLI_COMMAND("get", "Print an NVS field, \"get <name> [index]\"", dbg_nvs_get),
+    CLI_COMMAND("info", "Get device info", dbg_device_info),
+    CLI_COMMAND("irq_stats", "Report per-source interrupt counts and entry-to-service latency (cycles), "
+        "\"irq_stats reset\" clears the stats", dbg_irq_stats),
+    CLI_COMMAND("list", "List NVS fields with their types and allowed ranges", dbg_nvs_list),
+    CLI_COMMAND("load", "Report CPU load and idle time, \"load reset\" clears the totals", dbg_load_report),
+    CLI_COMMAND("macro", "Command sequences kept in EEPROM, no args lists them.\n"
+        "\t\"macro set <name> \"cmd1;cmd2\"\" stores one\n"
+        "\t\"macro run <name>\" runs it, stops at the first failure\n"
+        "\t\"macro del <name>\" removes it", dbg_nvs_macro),
+    CLI_COMMAND("mem", "Report heap, arena, pool and stack usage with high-water marks and failures", dbg_mem_report),
+    CLI_COMMAND("nvs_dump", "Hex dump of the RAM cache", dbg_nvs_dump),
+    CLI_COMMAND("nvs_load", "Load non-volatile data from EEPROM", dbg_nvs_load),
+    CLI_COMMAND("nvs_report", "Report NVS contents in human-readable format", dbg_nvs_report),
+    CLI_COMMAND("nvs_reset", "Reset NVS (sets NVS partiton version to 0 [invalid], doesn't actually erase the EEPROM)",
+        dbg_nvs_reset),
+    CLI_COMMAND("nvs_save", "Save current non-volatile data into EEPROM", dbg_nvs_save),
+    CLI_COMMAND_BUDGET("nvs_test", "Test NVS read-write and CRC calculation", dbg_nvs_test, 1000),
+    CLI_COMMAND("perf", "Report main loop and task cycle counts.\n\t\"perf hist\" adds log2 histograms\n\t\"perf reset\" clears the stats",
+        dbg_perf_report),
+    CLI_COMMAND("reset", "Reboot MCU", cli_reset),
+    CLI_COMMAND("sched", "Report scheduler task timing, \"sched reset\" clears the stats", dbg_sched_report),
+    CLI_COMMAND("set", "Change an NVS field in RAM (\"nvs_save\" to keep it), \"set <name> [index] <value>\"",
+        dbg_nvs_set),
+    CLI_COMMAND("telem", "Binary telemetry (decode with tools/telem_decode).\n\t\"telem on|off\" starts/stops streaming\n"
+        "\t\"telem reset\" clears the counters", dbg_telem),
+#if MY_TRACE_ENABLE
+    CLI_COMMAND("trace_dump", "Dump the trace buffer as telemetry frames (decode with tools/trace2json.py) "
+        "and restart tracing", dbg_trace_dump),
+#endif
+    CLI_COMMAND("uart", "Report console TX/RX counters.\n\t\"uart reset\" clears them\n"
+        "\t\"uart drop|block|overwrite\" sets the full buffer policy", dbg_uart_report),
+};
+const size_t cli_static_commands_count = sizeof(cli_static_commands) / sizeof(cli_static_commands[0]);
+
 /***
  * Private API
  */
 
-int try_parse_float(char* arg, float* val)
+static const char* const field_type_names[] = {
+    [MY_NVS_TYPE_U32] = "u32",
+    [MY_NVS_TYPE_F32] = "f32",
+    [MY_NVS_TYPE_BOOL] = "bool"
+};
+
+static my_parse_err_t report_parse_err(const char* arg, my_parse_err_t err)
 {
-    if (sscanf(arg, "%f", val) != 1) return 2;
-    return 0;
+    if (err != MY_PARSE_OK) xprintf("\"%s\": %s\n", arg, my_parse_strerror(err));
+    return err;
+}
+static my_parse_err_t parse_value(my_nvs_type_t type, const char* arg, my_nvs_value_t* value)
+{
+    if (type == MY_NVS_TYPE_F32) return report_parse_err(arg, my_parse_float(arg, &(value->f)));
+    return report_parse_err(arg, my_parse_u32(arg, &(value->u)));
+}
+static void print_value(my_nvs_type_t type, my_nvs_value_t value)
+{
+    if (type == MY_NVS_TYPE_F32) xprintf("%f", value.f);
+    else xprintf("%" PRIu32, value.u);
+}
+static void print_kv(const char* key, my_nvs_type_t type, my_nvs_value_t value)
+{
+    if (type == MY_NVS_TYPE_F32) cli_kv_f32(key, value.f);
+    else cli_kv_u32(key, value.u);
+}
+//Arrays as name[i]
+static void print_field(const my_nvs_field_t* field)
+{
+    char key[48];
+    size_t len = strlen(field->name);
+
+    if (len > (sizeof(key) - sizeof("[255]"))) len = sizeof(key) - sizeof("[255]");
+    if (field->count == 1)
+    {
+        my_nvs_value_t value;
+        my_nvs_field_get(field, 0, &value);
+        print_kv(field->name, field->type, value);
+        return;
+    }
+    memcpy(key, field->name, len);
+    for (size_t i = 0; i < field->count; i++)
+    {
+        my_nvs_value_t value;
+        my_nvs_field_get(field, i, &value);
+        xsprintf(&(key[len]), "[%u]", (unsigned)i);
+        print_kv(key, field->type, value);
+    }
 }
 
 /***
  * Public API
  */
 
-void my_dbg_console_init()
+/**
+ * @retval HAL_ERROR if the shell has no memory for its buffers
+ */
+HAL_StatusTypeDef my_dbg_console_init()
 {
     setvbuf(stdout, NULL, _IONBF, BUFSIZ);
 
-    CLI_INIT();
-
-    CLI_ADD_CMD("reset", "Reboot MCU", cli_reset);
-    CLI_ADD_CMD("info", "Get device info", dbg_device_info);
-    CLI_ADD_CMD("dbg_report", "Report debugging info", dbg_report);
-
-    CLI_ADD_CMD("nvs_save", "Save current non-volatile data into EEPROM", dbg_nvs_save);
-    CLI_ADD_CMD("nvs_load", "Load non-volatile data from EEPROM", dbg_nvs_load);
-    CLI_ADD_CMD("nvs_reset", "Reset NVS (sets NVS partiton version to 0 [invalid], doesn't actually erase the EEPROM)",
-        dbg_nvs_reset);
-    CLI_ADD_CMD("nvs_report", "Report NVS contents in human-readable format", dbg_nvs_report);
-    CLI_ADD_CMD("nvs_test", "Test NVS read-write and CRC calculation", dbg_nvs_test);
-    CLI_ADD_CMD("nvs_dump", "Hex dump of the RAM cache", dbg_nvs_dump);
-    CLI_ADD_CMD("err_store_report", "Print the contents of error memory", dbg_nvs_print_errors);
+    return CLI_INIT() ? HAL_OK : HAL_ERROR;
+}
+/**
+ * @brief Time source for resumable command budgets
+ */
+uint32_t cli_micros(void)
+{
+    return get_micros_32();
+}
+/**
+ * @brief Machine mode wants no colours
+ */
+void cli_plain_output(bool plain)
+{
+    set_uart_plain_output(plain);
 }
 
 /***
@@ -94,42 +202,138 @@ uint8_t cli_reset(int argc, char *argv[])
     if ((ret = wdt_start()) != HAL_OK) return ret;
 #endif
 	NL1();xprintf("[END]: System Rebooting");NL1();
+    uart_tx_flush();
 	while (1);
 	return 0;
 }
 uint8_t dbg_device_info(int argc, char** argv)
 {
-    xputs(MY_FIRMWARE_INFO_STR "\n");
+    cli_kv_str("fw", MY_FIRMWARE_INFO_STR);
     return 0;
 }
 uint8_t dbg_report(int argc, char** argv)
 {
-    register void *sp asm ("sp");
-    xprintf("SP = %08" PRIXPTR "\n"
-        "MTVAL = %08" PRIX32 "\n"
-        "MEPC = %08" PRIX32 "\n"
-        "MCAUSE = %08" PRIX32 "\n"
-        "MIP = %08" PRIX32 "\n"
-        "EECON = %08" PRIX32 "\n"
-        "EEADJ = %08" PRIX32 "\n"
-        "EESTA = %08" PRIX32 "\n",
-        sp, read_csr(mtval), read_csr(mepc), read_csr(mcause), read_csr(mip),
-        EEPROM_REGS->EECON, EEPROM_REGS->EEADJ, EEPROM_REGS->EESTA);
-    uint32_t eeprom_crc;
-    if (my_nvs_get_whole_eeprom_crc32(&eeprom_crc) == HAL_OK)
-    {
-        xprintf("EEPROM CRC = %08" PRIX32 "\n", eeprom_crc);
+    HAL_StatusTypeDef ret = HAL_OK;
+
+    CLI_PT_BEGIN(my_nvs_crc_t, crc);
+    {
+        register void *sp asm ("sp");
+        xprintf("SP = %08" PRIXPTR "\n"
+            "MTVAL = %08" PRIX32 "\n"
+            "MEPC = %08" PRIX32 "\n"
+            "MCAUSE = %08" PRIX32 "\n"
+            "MIP = %08" PRIX32 "\n"
+            "EECON = %08" PRIX32 "\n"
+            "EEADJ = %08" PRIX32 "\n"
+            "EESTA = %08" PRIX32 "\n",
+            sp, read_csr(mtval), read_csr(mepc), read_csr(mcause), read_csr(mip),
+            EEPROM_REGS->EECON, EEPROM_REGS->EEADJ, EEPROM_REGS->EESTA);
+    }
+    //One page per step, the main loop keeps running in between
+    while ((ret = my_nvs_eeprom_crc32_step(crc)) == HAL_BUSY) CLI_PT_YIELD_IF_EXPIRED();
+    if (ret == HAL_OK)
+    {
+        xprintf("EEPROM CRC = %08" PRIX32 "\n", crc->crc);
     }
     else
     {
         xputs("Failed to calculate EEPROM CRC!\n");
     }
+    CLI_PT_END();
+    return 0;
+}
+uint8_t dbg_sched_report(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        if (strcmp(argv[1], "reset") != 0) return 1;
+        my_sched_reset_stats();
+        return 0;
+    }
+    xputs("Task\tPeriod\tRuns\tOverruns\tLate max\tPeriod min\tPeriod max\n");
+    for (size_t i = 0; i < my_sched_get_task_count(); i++)
+    {
+        const my_sched_task_t* task = my_sched_get_task(i);
+        xprintf("%s\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\n",
+            task->name, task->timer.interval, task->runs, task->overruns, task->max_lateness,
+            task->runs > 1 ? task->min_period : 0, task->max_period);
+    }
+    return 0;
+}
+uint8_t dbg_perf_report(int argc, char** argv)
+{
+    bool histograms = false;
+    if (argc > 1)
+    {
+        if (strcmp(argv[1], "reset") == 0)
+        {
+            my_perf_reset();
+            return 0;
+        }
+        if (strcmp(argv[1], "hist") != 0) return 1;
+        histograms = true;
+    }
+    my_perf_report(histograms);
+    return 0;
+}
+uint8_t dbg_trace_dump(int argc, char** argv)
+{
+#if MY_TRACE_ENABLE
+    my_trace_dump();
+    return 0;
+#else
+    return 1;
+#endif
+}
+uint8_t dbg_irq_stats(int argc, char** argv)
+{
+    static const char* const names[MY_IRQ_SRC_TOTAL] = { "wdt", "uart", "dma", "eeprom", "ctrl" };
+    my_perf_stat_t stat;
+
+    if (argc > 1)
+    {
+        if (strcmp(argv[1], "reset") != 0) return 1;
+        reset_irq_stats();
+        return 0;
+    }
+    xputs("Source\t\tCount\tMin\tMean\tMax\n");
+    for (size_t i = 0; i < MY_IRQ_SRC_TOTAL; i++)
+    {
+        get_irq_stats((my_irq_source_t)i, &stat);
+        my_perf_stat_print(names[i], &stat);
+        xputc('\n');
+        my_perf_stat_print_hist(&stat);
+    }
+    uint64_t elapsed = get_trap_stats(&stat);
+    my_perf_stat_print("handler", &stat);
+    xputc('\n');
+    my_perf_stat_print_hist(&stat);
+    //Share of CPU time spent in the handler
+    uint64_t elapsed_cycles = elapsed * (OSC_SYSTEM_VALUE / 1000000u);
+    xprintf("Spurious: %" PRIu32 "\n", get_spurious_irq_count());
+    xprintf("Handler time: %" PRIu32 " us of %" PRIu32 " ms (%" PRIu32 " ppm)\n",
+        (uint32_t)(stat.sum / (OSC_SYSTEM_VALUE / 1000000u)), (uint32_t)(elapsed / 1000u),
+        elapsed_cycles ? (uint32_t)((stat.sum * 1000000u) / elapsed_cycles) : 0);
+    return 0;
+}
+
+uint8_t dbg_mem_report(int argc, char** argv)
+{
+    my_mem_report();
+    my_stack_report();
     return 0;
 }
 
 uint8_t dbg_nvs_save(int argc, char** argv)
 {
-    return my_nvs_save();
+    my_nvs_save_stats_t stats;
+
+    HAL_StatusTypeDef ret = my_nvs_save();
+    my_nvs_get_save_stats(&stats);
+    cli_kv_u32("pages_written", stats.pages_written);
+    cli_kv_u32("pages_total", stats.pages_total);
+    cli_kv_u32("save_us", stats.time_us);
+    return ret;
 }
 uint8_t dbg_nvs_load(int argc, char** argv)
 {
@@ -141,104 +345,170 @@ uint8_t dbg_nvs_reset(int argc, char** argv)
 }
 uint8_t dbg_nvs_report(int argc, char** argv)
 {
-    //Common parts
-    xprintf("** EEPROM Error stats: %" PRIu32 " **\n"
-        "Casement: %" PRIu32 "\n"
-        "Motion timeout: %" PRIu32 "\n",
-        get_eeprom_error_stats(),
-        (uint32_t)(nvs_storage_handle->casement_config),
-        nvs_storage_handle->motion_timeout);
-    //Main motor settings
-    xprintf("Main motor:\n"
-        "\tJog target 0 = %f\n"
-        "\tJog target 1 = %f\n"
-        "\tAccel 0 = %f\n"
-        "\tAccel 1 = %f\n"
-        "\tEncoder 0 m/cts = %f\n"
-        "\tEncoder 1 m/cts = %f\n",
-        nvs_storage_handle->jog_target_speed_0,
-        nvs_storage_handle->jog_target_speed_1,
-        nvs_storage_handle->acceleration_target_0,
-        nvs_storage_handle->acceleration_target_1,
-        nvs_storage_handle->encoder_counts_to_meters_0,
-        nvs_storage_handle->encoder_counts_to_meters_1);
-    for (uint32_t i = 0; i < MAIN_MOTOR_COUNT; i++)
-    {
-        const pid_tunings_t* instance = &(nvs_storage_handle->tunings_0) + i;
-        xprintf("\tPID tunings %" PRIu32 ":\n"
-            "\t\tkI = %f\n"
-            "\t\tkP = %f\n"
-            "\t\tMin pwr = %f\n"
-            "\t\tBrk scale = %f\n",
-            i,
-            instance->kI,
-            instance->kP,
-            instance->min_power,
-            instance->brake_scaling);
-    }
-    for (uint32_t i = 0; i < MAIN_MOTOR_COUNT; i++)
-    {
-        xprintf("\tMain %" PRIu32 " dir: %" PRIu32 "\n"
-            "\tMain %" PRIu32 " I_lim = %f\n",
-            i, nvs_storage_handle->main_motor_dir[i],
-            i, nvs_storage_handle->main_current_limit[i]);
-    }
-    xprintf("\tTarget open 0 = %f\n"
-        "\tTarget closed 0 = %f\n"
-        "\tTarget p.open 0 = %f\n"
-        "\tTarget open 1 = %f\n"
-        "\tTarget closed 1 = %f\n"
-        "\tTarget p.open 1 = %f\n"
-        "\tHard brk time = %f\n"
-        "\tPos precision = %f\n",
-        nvs_storage_handle->target_open_distance_0,
-        nvs_storage_handle->target_closed_distance_0,
-        nvs_storage_handle->target_partial_open_distance_0,
-        nvs_storage_handle->target_open_distance_1,
-        nvs_storage_handle->target_closed_distance_1,
-        nvs_storage_handle->target_partial_open_distance_1,
-        nvs_storage_handle->hard_brake_time,
-        nvs_storage_handle->position_precision);
-    //AUX motor settings
-    for (uint32_t i = 0; i < AUX_MOTOR_COUNT; i++)
-    {
-        xprintf("AUX motor %" PRIu32 ":\n"
-            "\tPwr = %f\n"
-            "\tDir: %" PRIu32 "\n"
-            "\tI_lim = %f\n",
-            i,
-            nvs_storage_handle->aux_motor_power[i],
-            (uint32_t)(nvs_storage_handle->aux_motor_dir[i]),
-            nvs_storage_handle->aux_current_limit[i]);
-    }
-    //Seal
-    xprintf("Seal:\n"
-        "\tEn: %" PRIu32 "\n"
-        "\tVent target P = %f\n"
-        "\tPump max P = %f\n"
-        "\tPump min P = %f\n",
-        (uint32_t)(nvs_storage_handle->seal_enabled),
-        nvs_storage_handle->vent_target_pressure,
-        nvs_storage_handle->pump_max_pressure,
-        nvs_storage_handle->pump_min_pressure);
-    //Steps
-    xprintf("Steps:\n"
-        "\tEn: %" PRIu32 "\n"
-        "\tDual: %" PRIu32 "\n",
-        (uint32_t)(nvs_storage_handle->steps_enabled),
-        (uint32_t)(nvs_storage_handle->steps_dual));
-    //Coprocessor
-    xprintf("Coproc out inv: %06b\n", nvs_storage_handle->coproc_gpio_out_invert);
-    //Misc
+    size_t count;
+    const my_nvs_field_t* fields = my_nvs_get_fields(&count);
+
+    xprintf("** EEPROM Error stats: %" PRIu32 " **\n", get_eeprom_error_stats());
+    for (size_t i = 0; i < count; i++)
+    {
+        print_field(&(fields[i]));
+    }
     xprintf("NVS CRC = 0x%08" PRIX32 "\n"
         "NVS Ver = %" PRIu32 "\n",
         nvs_storage_handle->crc32,
         my_nvs_get_version());
     return 0;
 }
+uint8_t dbg_nvs_list(int argc, char** argv)
+{
+    size_t count;
+    const my_nvs_field_t* fields = my_nvs_get_fields(&count);
+
+    xputs("Name\tType[n]\tRange\n");
+    for (size_t i = 0; i < count; i++)
+    {
+        const my_nvs_field_t* f = &(fields[i]);
+        xprintf("%s\t%s[%" PRIu32 "]\t", f->name, field_type_names[f->type], (uint32_t)(f->count));
+        print_value(f->type, f->min);
+        xputs("..");
+        print_value(f->type, f->max);
+        xputc('\n');
+    }
+    return 0;
+}
+uint8_t dbg_nvs_get(int argc, char** argv)
+{
+    if (argc < 2) return 1;
+    const my_nvs_field_t* field = my_nvs_find_field(argv[1]);
+    if (!field)
+    {
+        xprintf("No field \"%s\", see \"list\"\n", argv[1]);
+        return 2;
+    }
+    if (argc > 2)
+    {
+        uint32_t index;
+        my_nvs_value_t value;
+        if (report_parse_err(argv[2], my_parse_u32(argv[2], &index)) != MY_PARSE_OK) return 3;
+        if (my_nvs_field_get(field, index, &value) != HAL_OK) return 3;
+        print_kv(field->name, field->type, value);
+        return 0;
+    }
+    print_field(field);
+    return 0;
+}
+uint8_t dbg_nvs_set(int argc, char** argv)
+{
+    //The value is the last argument, anything past "<name> [index] <value>" would silently shift it
+    if ((argc < 3) || (argc > 4))
+    {
+        xprintf("Usage: %s <name> [index] <value>\n", argv[0]);
+        return 1;
+    }
+    const my_nvs_field_t* field = my_nvs_find_field(argv[1]);
+    if (!field)
+    {
+        xprintf("No field \"%s\", see \"list\"\n", argv[1]);
+        return 2;
+    }
+    uint32_t index = 0;
+    if (argc > 3)
+    {
+        if (report_parse_err(argv[2], my_parse_u32(argv[2], &index)) != MY_PARSE_OK) return 3;
+    }
+    else if (field->count > 1)
+    {
+        xprintf("%s is an array, give an index\n", field->name);
+        return 3;
+    }
+    my_nvs_value_t value;
+    if (parse_value(field->type, argv[argc - 1], &value) != MY_PARSE_OK) return 4;
+    if (my_nvs_field_set(field, index, value) != HAL_OK)
+    {
+        xputs("Out of range: ");
+        print_value(field->type, field->min);
+        xputs("..");
+        print_value(field->type, field->max);
+        xputc('\n');
+        return 5;
+    }
+    return 0;
+}
+/**
+ * @return slot, MY_NVS_MACRO_COUNT if not found
+ */
+static size_t find_macro(const char* name, nvs_macro_t* macro)
+{
+    for (size_t i = 0; i < MY_NVS_MACRO_COUNT; i++)
+    {
+        if ((my_nvs_macro_read(i, macro) == HAL_OK) && (strcmp(macro->name, name) == 0)) return i;
+    }
+    return MY_NVS_MACRO_COUNT;
+}
+uint8_t dbg_nvs_macro(int argc, char** argv)
+{
+    nvs_macro_t macro;
+    size_t slot;
+
+    if (argc < 2)
+    {
+        for (size_t i = 0; i < MY_NVS_MACRO_COUNT; i++)
+        {
+            if (my_nvs_macro_read(i, &macro) == HAL_OK) cli_kv_str(macro.name, macro.body);
+        }
+        return 0;
+    }
+    if (argc < 3) return 1;
+    slot = find_macro(argv[2], &macro);
+    if (strcmp(argv[1], "set") == 0)
+    {
+        if (argc < 4) return 1;
+        if (slot == MY_NVS_MACRO_COUNT)
+        {
+            //Reuse the slot of the same name, otherwise take the first free one
+            for (slot = 0; slot < MY_NVS_MACRO_COUNT; slot++)
+            {
+                if (my_nvs_macro_read(slot, &macro) != HAL_OK) break;
+            }
+            if (slot == MY_NVS_MACRO_COUNT)
+            {
+                xputs("No free macro slots, \"macro del\" one\n");
+                return 2;
+            }
+        }
+        if ((strlen(argv[2]) >= MY_NVS_MACRO_NAME_LEN) || (strlen(argv[3]) >= MY_NVS_MACRO_BODY_LEN))
+        {
+            xprintf("Name is up to %u chars, body up to %u\n", MY_NVS_MACRO_NAME_LEN - 1, MY_NVS_MACRO_BODY_LEN - 1);
+            return 3;
+        }
+        return my_nvs_macro_write(slot, argv[2], argv[3]);
+    }
+    if (slot == MY_NVS_MACRO_COUNT)
+    {
+        xprintf("No macro \"%s\"\n", argv[2]);
+        return 2;
+    }
+    if (strcmp(argv[1], "run") == 0)
+    {
+        //Runs right after this command returns, in the same cli_run() tick unless something yields
+        if (!cli_script_insert(macro.body))
+        {
+            xputs("Script buffer full (nested too deep?)\n");
+            return 3;
+        }
+        return 0;
+    }
+    if (strcmp(argv[1], "del") == 0) return my_nvs_macro_erase(slot);
+    return 1;
+}
 uint8_t dbg_nvs_test(int argc, char** argv)
 {
-    return my_nvs_test();
+    HAL_StatusTypeDef ret = HAL_OK;
+
+    CLI_PT_BEGIN(my_nvs_test_t, test);
+    while ((ret = my_nvs_test_step(test)) == HAL_BUSY) CLI_PT_YIELD_IF_EXPIRED();
+    CLI_PT_END();
+    return ret;
 }
 uint8_t dbg_nvs_dump(int argc, char** argv)
 {
@@ -249,4 +519,109 @@ uint8_t dbg_nvs_print_errors(int argc, char** argv)
 {
     my_nvs_print_errors();
     return 0;
+}
+uint8_t dbg_ctrl_report(int argc, char** argv)
+{
+    my_ctrl_stats_t stats;
+
+    if (argc > 1)
+    {
+        if (strcmp(argv[1], "reset") != 0) return 1;
+        my_ctrl_reset_stats();
+        return 0;
+    }
+    my_ctrl_get_stats(&stats);
+    xprintf("Nominal period: %" PRIu32 " us\n"
+        "Ticks: %" PRIu32 "\n"
+        "Overruns: %" PRIu32 "\n"
+        "Missed: %" PRIu32 "\n"
+        "Jitter: %" PRIu32 " cycles\n"
+        "Name\t\tCount\tMin\tMean\tMax\n",
+        (uint32_t)MY_CTRL_PERIOD_US, stats.ticks, stats.overruns, stats.missed,
+        stats.period.count ? (stats.period.max - stats.period.min) : 0);
+    my_perf_stat_print("period", &(stats.period));
+    xputc('\n');
+    my_perf_stat_print("execution", &(stats.execution));
+    xputc('\n');
+    return 0;
+}
+uint8_t dbg_load_report(int argc, char** argv)
+{
+    my_idle_stats_t stats;
+
+    if (argc > 1)
+    {
+        if (strcmp(argv[1], "reset") != 0) return 1;
+        my_idle_reset_stats();
+        return 0;
+    }
+    my_idle_get_stats(&stats);
+    uint32_t total_load = stats.total_us ?
+        (uint32_t)(1000u - (stats.idle_us * 1000u) / stats.total_us) : 0;
+    xprintf("Load (last %" PRIu32 " ms): %" PRIu32 ".%" PRIu32 "%%\n"
+        "Load (since reset): %" PRIu32 ".%" PRIu32 "%%\n"
+        "Idle: %" PRIu32 " ms of %" PRIu32 " ms, %" PRIu32 " sleeps\n",
+        (uint32_t)(MY_IDLE_WINDOW_US / 1000u), stats.load_permille / 10u, stats.load_permille % 10u,
+        total_load / 10u, total_load % 10u,
+        (uint32_t)(stats.idle_us / 1000u), (uint32_t)(stats.total_us / 1000u), stats.sleeps);
+    return 0;
+}
+uint8_t dbg_uart_report(int argc, char** argv)
+{
+    uart_tx_stats_t stats;
+
+    if (argc > 1)
+    {
+        if (strcmp(argv[1], "reset") == 0)
+        {
+            reset_uart_tx_stats();
+            reset_uart_rx_stats();
+        }
+        else if (strcmp(argv[1], "drop") == 0) set_uart_tx_policy(UART_TX_DROP);
+        else if (strcmp(argv[1], "block") == 0) set_uart_tx_policy(UART_TX_BLOCK);
+        else if (strcmp(argv[1], "overwrite") == 0) set_uart_tx_policy(UART_TX_OVERWRITE);
+        else return 1;
+        return 0;
+    }
+    get_uart_tx_stats(&stats);
+    xprintf("TX sent: %" PRIu32 "\n"
+        "TX dropped: %" PRIu32 "\n"
+        "TX buffer high-water: %" PRIu32 " of %" PRIu32 "\n",
+        stats.sent, stats.dropped, stats.max_used, (uint32_t)UART_TX_BUF_SIZE);
+#if ENABLE_UART_RX_DMA
+    uart_rx_stats_t rx_stats;
+    get_uart_rx_stats(&rx_stats);
+    xprintf("RX received: %" PRIu32 "\n"
+        "RX dropped: %" PRIu32 "\n"
+        "RX overruns: %" PRIu32 "\n"
+        "RX parity errors: %" PRIu32 "\n"
+        "RX framing errors: %" PRIu32 "\n"
+        "RX idle events: %" PRIu32 "\n",
+        rx_stats.received, rx_stats.dropped, rx_stats.overruns,
+        rx_stats.parity_errors, rx_stats.framing_errors, rx_stats.idle_events);
+#endif
+    return 0;
+}
+uint8_t dbg_telem(int argc, char** argv)
+{
+    my_telem_stats_t stats;
+
+    if (argc > 1)
+    {
+        if (strcmp(argv[1], "on") == 0) my_telem_enable(true);
+        else if (strcmp(argv[1], "off") == 0) my_telem_enable(false);
+        else if (strcmp(argv[1], "reset") == 0) my_telem_reset_stats();
+        else return 1;
+        return 0;
+    }
+    my_telem_get_stats(&stats);
+    xprintf("Streaming: %s\n"
+        "Samples: %" PRIu32 "\n"
+        "Dropped: %" PRIu32 "\n"
+        "Frames: %" PRIu32 "\n",
+        my_telem_is_enabled() ? "on" : "off", stats.samples, stats.dropped, stats.frames);
+#if MY_DLOG_ENABLE
+    xprintf("Log records dropped: %" PRIu32 "\n", my_dlog_get_dropped());
+#endif
+    return 0;
 }
\ No newline at end of file
@@ -1,3 +1,5 @@
 #pragma once
 
-void my_dbg_console_init();
\ No newline at end of file
+#include <mik32_hal.h>
+
+HAL_StatusTypeDef my_dbg_console_init();
\ No newline at end of file
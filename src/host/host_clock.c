@@ -0,0 +1,27 @@
+#include "host_clock.h"
+
+#include <stdbool.h>
+#include <time.h>
+
+static bool fake = false;
+static uint32_t fake_us = 0;
+
+uint32_t get_micros_32(void)
+{
+    if (fake) return fake_us;
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+void host_clock_set(uint32_t us)
+{
+    fake = true;
+    fake_us = us;
+}
+void host_clock_advance(uint32_t us)
+{
+    fake = true;
+    fake_us += us;
+}
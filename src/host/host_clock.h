@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Host stand-in for the SCR1 microsecond timebase (get_micros_32(), MY_SCHED_HOST and MY_TWHEEL_HOST builds).
+ * Runs on CLOCK_MONOTONIC until a test takes it over with host_clock_set(), from then on it only moves
+ * with host_clock_set()/host_clock_advance().
+ */
+
+uint32_t get_micros_32(void);
+void host_clock_set(uint32_t us);
+void host_clock_advance(uint32_t us);
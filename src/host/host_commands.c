@@ -0,0 +1,30 @@
+#include "sys_command_line.h"
+
+#include <stdlib.h>
+
+/*
+ * Command table of the native build, shared by the interactive shell (host_main.c), the tests and the fuzzer
+ */
+
+uint8_t host_echo(int argc, char** argv);
+uint8_t host_fail(int argc, char** argv);
+
+const COMMAND_S cli_static_commands[] = {
+    CLI_COMMAND("echo", "Print the arguments one per line", host_echo),
+    CLI_COMMAND("fail", "Return \"fail <code>\" (default 1), to try out ';' batches", host_fail),
+};
+const size_t cli_static_commands_count = sizeof(cli_static_commands) / sizeof(cli_static_commands[0]);
+
+/**
+ * PUBLIC API
+ */
+
+uint8_t host_echo(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) xprintf("%s\n", argv[i]);
+    return 0;
+}
+uint8_t host_fail(int argc, char** argv)
+{
+    return (argc > 1) ? (uint8_t)atoi(argv[1]) : 1;
+}
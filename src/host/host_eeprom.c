@@ -0,0 +1,103 @@
+#include "host_eeprom.h"
+
+#include <string.h>
+
+#include <mik32_hal_eeprom.h>
+
+uint32_t host_eeprom[HOST_EEPROM_BYTES / 4u];
+static host_eeprom_op_t op_log[HOST_EEPROM_LOG_LEN];
+static size_t op_count = 0; //Also past the end of the log
+static uint32_t faults = 0;
+static uint32_t fail_in = 0; //Operations until the cut, 0 = never
+
+/**
+ * PRIVATE API
+ */
+
+static bool in_range(uint32_t address, uint32_t words)
+{
+    return ((address % 4u) == 0) && (address <= HOST_EEPROM_BYTES) && (words <= ((HOST_EEPROM_BYTES - address) / 4u));
+}
+//Logs the operation, false when it is the one the power is cut on
+static bool operation(bool erase, uint32_t address)
+{
+    if (op_count < HOST_EEPROM_LOG_LEN) op_log[op_count] = (host_eeprom_op_t){ .erase = erase, .address = address };
+    op_count++;
+    return !(fail_in && (--fail_in == 0));
+}
+
+/**
+ * PUBLIC API
+ */
+
+void host_eeprom_blank(void)
+{
+    memset(host_eeprom, 0, sizeof(host_eeprom));
+    faults = 0;
+    fail_in = 0;
+    host_eeprom_clear_log();
+}
+void host_eeprom_clear_log(void)
+{
+    op_count = 0;
+}
+size_t host_eeprom_get_log(const host_eeprom_op_t** ops)
+{
+    *ops = op_log;
+    return (op_count < HOST_EEPROM_LOG_LEN) ? op_count : HOST_EEPROM_LOG_LEN;
+}
+uint32_t host_eeprom_get_faults(void)
+{
+    return faults;
+}
+void host_eeprom_fail_after(uint32_t ops)
+{
+    fail_in = ops;
+}
+
+void HAL_EEPROM_Init(HAL_EEPROM_HandleTypeDef* eeprom)
+{
+    (void)eeprom;
+}
+void HAL_EEPROM_CalculateTimings(HAL_EEPROM_HandleTypeDef* eeprom, uint32_t sys_freq)
+{
+    (void)eeprom;
+    (void)sys_freq;
+}
+HAL_StatusTypeDef HAL_EEPROM_Read(HAL_EEPROM_HandleTypeDef* eeprom, uint32_t address, uint32_t* data, uint32_t size,
+    uint32_t timeout)
+{
+    (void)eeprom;
+    (void)timeout;
+    if (!in_range(address, size)) return HAL_ERROR;
+    memcpy(data, &(host_eeprom[address / 4u]), size * 4u);
+    return HAL_OK;
+}
+HAL_StatusTypeDef HAL_EEPROM_Write(HAL_EEPROM_HandleTypeDef* eeprom, uint32_t address, uint32_t* data, uint32_t size,
+    uint32_t write_mode, uint32_t timeout)
+{
+    (void)eeprom;
+    (void)write_mode;
+    (void)timeout;
+    if (!in_range(address, size)) return HAL_ERROR;
+    bool ok = operation(false, address);
+    uint32_t words = ok ? size : (size / 2u);
+    for (uint32_t i = 0; i < words; i++)
+    {
+        uint32_t* word = &(host_eeprom[address / 4u + i]);
+        if (*word != 0) faults++;
+        *word = data[i];
+    }
+    return ok ? HAL_OK : HAL_ERROR;
+}
+HAL_StatusTypeDef HAL_EEPROM_Erase(HAL_EEPROM_HandleTypeDef* eeprom, uint32_t address, uint32_t size,
+    uint32_t write_mode, uint32_t timeout)
+{
+    (void)eeprom;
+    (void)write_mode;
+    (void)timeout;
+    if (!in_range(address, size)) return HAL_ERROR;
+    if (!operation(true, address)) return HAL_ERROR;
+    memset(&(host_eeprom[address / 4u]), 0, size * 4u);
+    return HAL_OK;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Host stand-in for the 8 KB EEPROM (MY_NVS_HOST builds). Erased words read as 0, programming a word that
+ * isn't erased is counted as a fault. Every erase and write is logged with its address until the next
+ * host_eeprom_clear_log(). host_eeprom_fail_after(n) cuts the power on the n-th operation from now:
+ * an erase fails without effect, a write programs the first half of its words and fails.
+ */
+
+#define HOST_EEPROM_BYTES 8192u
+#define HOST_EEPROM_LOG_LEN 64u
+
+typedef struct
+{
+    bool erase;
+    uint32_t address;
+} host_eeprom_op_t;
+
+extern uint32_t host_eeprom[HOST_EEPROM_BYTES / 4u];
+
+void host_eeprom_blank(void);
+void host_eeprom_clear_log(void);
+size_t host_eeprom_get_log(const host_eeprom_op_t** ops);
+uint32_t host_eeprom_get_faults(void);
+void host_eeprom_fail_after(uint32_t ops);
@@ -0,0 +1,61 @@
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <xprintf.h>
+
+/*
+ * Console and clock of the native build. Output goes to stdout unless xdev_out() sets a function,
+ * as ChaN's xprintf does on the target; tests capture it that way.
+ */
+
+static void (*out_func)(int c) = NULL;
+
+/**
+ * PUBLIC API
+ */
+
+void xputc(int c)
+{
+    if (out_func) out_func(c);
+    else putchar(c);
+}
+void xputs(const char* str)
+{
+    if (out_func) while (*str) out_func(*str++);
+    else fputs(str, stdout);
+}
+void xprintf(const char* fmt, ...)
+{
+    char buf[512];
+    va_list args;
+
+    va_start(args, fmt);
+    if (out_func)
+    {
+        vsnprintf(buf, sizeof(buf), fmt, args);
+        xputs(buf);
+    }
+    else vprintf(fmt, args);
+    va_end(args);
+}
+void xsprintf(char* buff, const char* fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vsprintf(buff, fmt, args);
+    va_end(args);
+}
+void xdev_out(void (*func)(int))
+{
+    out_func = func;
+}
+uint32_t cli_micros(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
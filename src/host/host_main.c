@@ -0,0 +1,73 @@
+#include "sys_command_line.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+/*
+ * Native build of the shell layer ("pio run -e native"): sys_command_line.c as it is on the target,
+ * fed from stdin the same way main.c feeds them from the UART. A terminal is switched to raw mode so that
+ * the line editor sees every key; piped input (e.g. a script) is passed through byte for byte.
+ * Not part of "pio test -e native", the test runner brings its own main().
+ */
+#ifndef PIO_UNIT_TESTING
+
+static struct termios saved_termios;
+
+/**
+ * PRIVATE API
+ */
+
+static void restore_terminal(void)
+{
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+}
+static void raw_terminal(void)
+{
+    struct termios raw;
+
+    if (!isatty(STDIN_FILENO) || (tcgetattr(STDIN_FILENO, &saved_termios) != 0)) return;
+    raw = saved_termios;
+    raw.c_lflag &= ~(ICANON | ECHO | ISIG); //Ctrl-C goes to the shell, "reset"-less exit is Ctrl-D
+    raw.c_iflag &= ~(ICRNL | IXON);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    atexit(restore_terminal);
+}
+
+/**
+ * PUBLIC API
+ */
+
+int main(void)
+{
+    unsigned char chunk[64];
+
+    raw_terminal();
+    if (!cli_init()) return 1;
+    fflush(stdout);
+    while (1)
+    {
+        //Same pacing as cli_task_callback(): a resumable command gets one slice per pass, input waits meanwhile
+        if (cli_busy() || (cli_rx_free() == 0))
+        {
+            cli_run();
+            continue;
+        }
+        size_t len = cli_rx_free();
+        if (len > sizeof(chunk)) len = sizeof(chunk);
+        ssize_t got = read(STDIN_FILENO, chunk, len);
+        if ((got <= 0) || ((got == 1) && (chunk[0] == 0x04))) break; //EOF or Ctrl-D
+        cli_uart_rx(chunk, (size_t)got);
+        cli_run();
+        fflush(stdout);
+    }
+    while (cli_busy()) cli_run();
+    cli_run();
+    xputc('\n');
+    return 0;
+}
+
+#endif
@@ -0,0 +1,12 @@
+//The linker script's heap bounds for my_mem.c: a plain array, newlib's malloc() doesn't go through it on the host
+
+#define HOST_HEAP_SIZE 4096
+#define STR(x) #x
+#define XSTR(x) STR(x)
+
+char host_heap[HOST_HEAP_SIZE];
+
+__asm__(".globl __heap_start\n"
+        "__heap_start = host_heap\n"
+        ".globl __heap_end\n"
+        "__heap_end = host_heap + " XSTR(HOST_HEAP_SIZE) "\n");
@@ -0,0 +1,27 @@
+#pragma once
+
+//Host stand-in for the SDK header, only what the shell layer uses
+
+typedef enum
+{
+    HAL_OK = 0,
+    HAL_ERROR = 1,
+    HAL_BUSY = 2,
+    HAL_TIMEOUT = 3
+} HAL_StatusTypeDef;
+
+#define OSC_SYSTEM_VALUE 32000000
+#ifndef __noinline
+#define __noinline __attribute__((noinline)) //newlib's <sys/cdefs.h> on the target
+#endif
+
+//The host has no interrupts to mask
+#define MSTATUS_MIE 0x8u
+#define clear_csr(reg, bit) host_csr(bit)
+#define set_csr(reg, bit) host_csr(bit)
+
+static inline unsigned host_csr(unsigned bit)
+{
+    (void)bit;
+    return 0;
+}
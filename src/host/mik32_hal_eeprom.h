@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "mik32_hal.h"
+
+//Host stand-in for the SDK's EEPROM driver, only what nvs.c uses. host_eeprom.c is the memory behind it.
+
+typedef struct
+{
+    void* Instance;
+    uint32_t Mode;
+    uint32_t ErrorCorrection;
+    uint32_t EnableInterrupt;
+} HAL_EEPROM_HandleTypeDef;
+
+#define EEPROM_REGS NULL
+#define HAL_EEPROM_MODE_THREE_STAGE 0
+#define HAL_EEPROM_ECC_ENABLE 0
+#define HAL_EEPROM_SERR_DISABLE 0
+#define HAL_EEPROM_WRITE_SINGLE 0
+
+void HAL_EEPROM_Init(HAL_EEPROM_HandleTypeDef* eeprom);
+void HAL_EEPROM_CalculateTimings(HAL_EEPROM_HandleTypeDef* eeprom, uint32_t sys_freq);
+HAL_StatusTypeDef HAL_EEPROM_Read(HAL_EEPROM_HandleTypeDef* eeprom, uint32_t address, uint32_t* data, uint32_t size,
+    uint32_t timeout);
+HAL_StatusTypeDef HAL_EEPROM_Write(HAL_EEPROM_HandleTypeDef* eeprom, uint32_t address, uint32_t* data, uint32_t size,
+    uint32_t write_mode, uint32_t timeout);
+HAL_StatusTypeDef HAL_EEPROM_Erase(HAL_EEPROM_HandleTypeDef* eeprom, uint32_t address, uint32_t size,
+    uint32_t write_mode, uint32_t timeout);
@@ -0,0 +1,9 @@
+#pragma once
+
+//Host stand-in for ChaN's xprintf: stdout, or the function set with xdev_out()
+
+void xputc(int c);
+void xputs(const char* str);
+void xprintf(const char* fmt, ...);
+void xsprintf(char* buff, const char* fmt, ...);
+void xdev_out(void (*func)(int));
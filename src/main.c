@@ -4,16 +4,34 @@
 #include "nvs.h"
 #include "sys_command_line.h"
 #include "dbg_console.h"
+#include "my_sched.h"
+#include "my_twheel.h"
+#include "my_perf.h"
+#include "my_trace.h"
+#include "my_ctrl.h"
+#include "my_idle.h"
+#include "my_telem.h"
+#include "my_dlog.h"
+#include "my_mem.h"
+#include "my_stack.h"
+
+static void led_task_callback(void* ctx);
+static void cli_task_callback(void* ctx);
+static void twheel_task_callback(void* ctx);
+static void telem_task_callback(void* ctx);
 
-soft_timer led_timer = { .interval = 1000000 };
-soft_timer cli_timer = { .interval = 5000 };
 soft_timer spi_timer = { .interval = 12000 };
+static my_sched_task_t led_task = MY_SCHED_TASK("led", led_task_callback, 1000000);
+static my_sched_task_t cli_task = MY_SCHED_TASK("cli", cli_task_callback, 5000);
+static my_sched_task_t twheel_task = MY_SCHED_TASK("twheel", twheel_task_callback, MY_TWHEEL_TICK_US);
+static my_sched_task_t telem_task = MY_SCHED_TASK("telem", telem_task_callback, 5000);
 
 nvs_storage_t* nvs_storage_handle = NULL;
 
 static void die(void)
 {
     xputs("=== DIE ===\n");
+    uart_tx_flush();
     uint32_t delay = get_micros_32();
     while (get_time_past_32(delay) < 5000000)
     {
@@ -24,14 +42,52 @@ static void die(void)
     __unreachable();
 }
 
+static void led_task_callback(void* ctx)
+{
+    //static float dummy = 0;
+
+    toggle_green_led();
+    //xprintf("Tick %.2f\n", dummy);
+    //dummy += 1.5f;
+}
+static void cli_task_callback(void* ctx)
+{
+    TRACE_BEGIN(CLI);
+#if ENABLE_UART_RX_DMA
+    //Hand over only what the shell queue can take, the rest waits in the DMA buffer
+    uint8_t chunk[CLI_RX_BUFF_LEN];
+    size_t len;
+    do
+    {
+        len = uart_rx_read(chunk, cli_rx_free());
+        cli_uart_rx(chunk, len);
+        cli_run();
+    } while ((len > 0) && !cli_busy()); //A resumable command gets one slice per tick
+#else
+    cli_run();
+#endif
+    TRACE_END(CLI);
+}
+static void twheel_task_callback(void* ctx)
+{
+    my_twheel_tick();
+}
+static void telem_task_callback(void* ctx)
+{
+    my_telem_flush();
+    my_dlog_flush();
+}
+
 int main()
 { 
+    my_stack_paint(); //Interrupts are still off
     HAL_StatusTypeDef init_result = my_hal_init();
     xprintf("Init result: %" PRIu32 "\n", init_result);
     if (__builtin_expect(init_result != HAL_OK, 0)) while (1);
+    if (my_dlog_init() != HAL_OK) die(); //Before the first LOG()
 
     //Initialize debug console
-    my_dbg_console_init();
+    if (my_dbg_console_init() != HAL_OK) die();
 
     //Initialize NVS
     xputs("Init NVS... ");
@@ -45,9 +101,34 @@ int main()
     xputs("Finished.\n");
     wdt_reset();
 
+    //Subsystem buffers
+    if (my_telem_init() != HAL_OK) die();
+
+    //Periodic jobs
+    my_sched_init();
+    my_sched_add_periodic(&led_task);
+    my_sched_add_periodic(&cli_task);
+    my_twheel_init();
+    my_sched_add_periodic(&twheel_task);
+    my_sched_add_periodic(&telem_task);
+
+    //Hard real-time control tick, everything else stays in the background loop
+    if (my_ctrl_start() != HAL_OK) die();
+    my_idle_init();
+    my_mem_seal(); //Boot is over, no more heap
+
     while (1)
     {
+        my_perf_loop_begin();
         wdt_reset();
+#if ENABLE_STACK_CANARY
+        if (__builtin_expect(!my_stack_canary_ok(), 0))
+        {
+            my_nvs_save_error(MY_ERR_STACK_OVERFLOW, (uint16_t)my_stack_get_high_water());
+            xputs("Stack overflow!\n");
+            die();
+        }
+#endif
         /*if (check_soft_timer(&spi_timer))
         {
             static uint16_t duty0 = 0;
@@ -61,18 +142,9 @@ int main()
             duty1 -= 10;
             if (duty1 <= 0) duty1 = PWM_TOP;
         }*/
-        if (check_soft_timer(&led_timer))
-        {
-            //static float dummy = 0;
-
-            toggle_green_led();
-            //xprintf("Tick %.2f\n", dummy);
-            //dummy += 1.5f;
-        }
-        if (check_soft_timer(&cli_timer))
-        {
-            cli_run();
-        }
+        my_sched_run();
+        my_perf_loop_end();
+        my_idle();
     }
     __unreachable();
 }
@@ -0,0 +1,82 @@
+#include "my_ctrl.h"
+#include "my_telem.h"
+
+#define CYCLES_PER_US (OSC_SYSTEM_VALUE / 1000000u)
+#define PERIOD_CYCLES (MY_CTRL_PERIOD_US * CYCLES_PER_US)
+
+typedef struct
+{
+    my_ctrl_callback_t callback;
+    void* ctx;
+} ctrl_entry_t;
+
+static ctrl_entry_t callbacks[MY_CTRL_MAX_CALLBACKS];
+static size_t callback_count = 0;
+static my_ctrl_stats_t stats = {};
+static uint32_t last_tick = 0;
+static bool started = false;
+
+/**
+ * PRIVATE API
+ */
+
+//Control tick, runs in the trap handler context
+static void RAM_ATTR ctrl_tick_handler(void)
+{
+    uint32_t start = read_csr(mcycle);
+    clear_ctrl_timer_irq();
+
+    if (stats.ticks > 0)
+    {
+        uint32_t period = start - last_tick;
+        my_perf_stat_add(&(stats.period), period);
+        my_telem_push_u32(MY_TELEM_CH_CTRL_PERIOD, period);
+        if (period > (PERIOD_CYCLES + PERIOD_CYCLES / 2)) stats.missed++;
+    }
+    last_tick = start;
+    stats.ticks++;
+
+    for (size_t i = 0; i < callback_count; i++)
+    {
+        callbacks[i].callback(callbacks[i].ctx);
+    }
+
+    uint32_t execution = read_csr(mcycle) - start;
+    my_perf_stat_add(&(stats.execution), execution);
+    my_telem_push_u32(MY_TELEM_CH_CTRL_EXEC, execution);
+    if (is_ctrl_timer_irq_pending()) stats.overruns++;
+}
+
+/**
+ * PUBLIC API
+ */
+
+/**
+ * @brief Add a callback to the control tick. Callbacks run in interrupt context, in registration order.
+ */
+HAL_StatusTypeDef my_ctrl_register(my_ctrl_callback_t callback, void* ctx)
+{
+    if (started || (callback_count >= MY_CTRL_MAX_CALLBACKS)) return HAL_ERROR;
+    callbacks[callback_count].callback = callback;
+    callbacks[callback_count].ctx = ctx;
+    callback_count++;
+    return HAL_OK;
+}
+HAL_StatusTypeDef my_ctrl_start(void)
+{
+    HAL_StatusTypeDef ret = start_ctrl_timer(MY_CTRL_PERIOD_US, ctrl_tick_handler);
+    started = (ret == HAL_OK);
+    return ret;
+}
+void my_ctrl_get_stats(my_ctrl_stats_t* out)
+{
+    uint32_t irq_state = my_irq_save();
+    *out = stats;
+    my_irq_restore(irq_state);
+}
+void my_ctrl_reset_stats(void)
+{
+    uint32_t irq_state = my_irq_save();
+    stats = (my_ctrl_stats_t){ 0 };
+    my_irq_restore(irq_state);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "my_hal.h"
+#include "my_pid.h"
+#include "my_perf.h"
+
+#define MY_CTRL_PERIOD_US MY_PID_DELTA_TIME
+#define MY_CTRL_MAX_CALLBACKS 4
+
+typedef void (*my_ctrl_callback_t)(void* ctx);
+
+typedef struct
+{
+    uint32_t ticks;
+    uint32_t overruns; //Callbacks still running when the next tick was due
+    uint32_t missed; //Ticks that came more than half a period late
+    my_perf_stat_t period; //Cycles between tick starts
+    my_perf_stat_t execution; //Cycles spent in the callbacks
+} my_ctrl_stats_t;
+
+HAL_StatusTypeDef my_ctrl_register(my_ctrl_callback_t callback, void* ctx);
+HAL_StatusTypeDef my_ctrl_start(void);
+void my_ctrl_get_stats(my_ctrl_stats_t* stats);
+void my_ctrl_reset_stats(void);
@@ -0,0 +1,83 @@
+#include "my_dlog.h"
+
+#if MY_DLOG_ENABLE
+
+#include "my_hal.h"
+#include "my_mem.h"
+#include "my_telem.h"
+
+#define PAYLOAD_WORDS (MY_TELEM_MAX_PAYLOAD / sizeof(uint32_t))
+
+MY_ARENA(arena, "dlog", sizeof(uint32_t) * (MY_DLOG_BUF_WORDS + PAYLOAD_WORDS));
+//Records are whole words, filled from any context and drained by my_dlog_flush() in the main loop
+static uint32_t* buffer = NULL;
+static uint32_t* payload = NULL; //One frame being assembled
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+static uint32_t dropped_since_frame = 0;
+static uint32_t dropped_total = 0;
+
+/**
+ * @brief Buffers come from the dlog arena, records written before this are dropped (and counted)
+ */
+HAL_StatusTypeDef my_dlog_init(void)
+{
+    if (my_arena_init(&arena) != HAL_OK) return HAL_ERROR;
+    payload = my_arena_alloc(&arena, sizeof(uint32_t) * PAYLOAD_WORDS);
+    buffer = my_arena_alloc(&arena, sizeof(uint32_t) * MY_DLOG_BUF_WORDS); //Last, enables my_dlog_write()
+    head = 0;
+    tail = 0;
+    return (buffer && payload) ? HAL_OK : HAL_ERROR;
+}
+/**
+ * @brief Append a record, safe to call from interrupt context. Use MY_DLOG() instead of calling this directly.
+ */
+void RAM_ATTR my_dlog_write(uint8_t level, uint32_t id, const uint32_t* args, uint32_t count)
+{
+    uint32_t now = get_micros_32();
+    uint32_t irq_state = my_irq_save();
+    uint32_t h = head;
+    if (!buffer || ((MY_DLOG_BUF_WORDS - (h - tail)) < (count + 2)))
+    {
+        dropped_since_frame++;
+        dropped_total++;
+    }
+    else
+    {
+        buffer[h++ & (MY_DLOG_BUF_WORDS - 1)] = (id & 0xFFFFu) | ((uint32_t)level << 16) | (count << 24);
+        buffer[h++ & (MY_DLOG_BUF_WORDS - 1)] = now;
+        for (uint32_t i = 0; i < count; i++) buffer[h++ & (MY_DLOG_BUF_WORDS - 1)] = args[i];
+        head = h;
+    }
+    my_irq_restore(irq_state);
+}
+/**
+ * @brief Send the buffered records as telemetry frames, records are never split between frames
+ */
+void my_dlog_flush(void)
+{
+    while (head != tail)
+    {
+        uint32_t h = head;
+        uint32_t t = tail;
+        size_t len = 0;
+        while (t != h)
+        {
+            uint32_t words = (buffer[t & (MY_DLOG_BUF_WORDS - 1)] >> 24) + 2;
+            if ((len + words) > PAYLOAD_WORDS) break;
+            for (uint32_t i = 0; i < words; i++) payload[len++] = buffer[t++ & (MY_DLOG_BUF_WORDS - 1)];
+        }
+        tail = t;
+        uint32_t irq_state = my_irq_save();
+        uint32_t dropped = dropped_since_frame;
+        dropped_since_frame = 0;
+        my_irq_restore(irq_state);
+        my_telem_send(MY_TELEM_FRAME_LOG, payload, len * sizeof(uint32_t), dropped);
+    }
+}
+uint32_t my_dlog_get_dropped(void)
+{
+    return dropped_total;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mik32_hal.h>
+
+#ifndef MY_DLOG_ENABLE
+#define MY_DLOG_ENABLE 0 //Route LOG()/ERR()/DBG() through the deferred backend (i.e. -D MY_DLOG_ENABLE=1)
+#endif
+#define MY_DLOG_BUF_WORDS 256 //Has to be a power of two
+#define MY_DLOG_MAX_ARGS 8
+#define MY_DLOG_LEVEL_ERR 0xFE //Levels below 32 are cli_log_stat categories
+#define MY_DLOG_LEVEL_DBG 0xFD
+
+/*
+ * Deferred logging: the format string is placed in .dlog_fmt, a section that is kept in the ELF but never loaded
+ * (the trailing '#' comments out the flags gcc appends). Its offset in that section is the string ID.
+ * The device only stores the ID, a timestamp and the raw 32-bit arguments; tools/dlog_decode.py does the formatting.
+ * Record layout (words): ID | level << 16 | argument word count << 24, time in us, arguments.
+ * Integers up to 32 bits take one word, long long (%lld/%llu/%llx, PRId64...) two words, low word first.
+ * Floats and doubles are sent as float bits. Pointers have to be char* (%s) or void* (%p): cast others.
+ * Any other argument type is a compile-time error instead of being silently truncated.
+ * %s only works for strings that live in the firmware image (the host looks them up in the ELF).
+ */
+#define MY_DLOG_SECTION __attribute__(( section(".dlog_fmt,\"\",@progbits #"), used ))
+
+#if MY_DLOG_ENABLE
+
+HAL_StatusTypeDef my_dlog_init(void);
+void my_dlog_write(uint8_t level, uint32_t id, const uint32_t* args, uint32_t count);
+void my_dlog_flush(void);
+uint32_t my_dlog_get_dropped(void);
+
+//Argument writers, each stores its value at p and returns the next free word
+static inline uint32_t* my_dlog_u32(uint32_t* p, uint32_t v)
+{
+    *p = v;
+    return p + 1;
+}
+static inline uint32_t* my_dlog_i32(uint32_t* p, int32_t v)
+{
+    return my_dlog_u32(p, (uint32_t)v);
+}
+static inline uint32_t* my_dlog_u64(uint32_t* p, unsigned long long v)
+{
+    p[0] = (uint32_t)v;
+    p[1] = (uint32_t)(v >> 32);
+    return p + 2;
+}
+static inline uint32_t* my_dlog_i64(uint32_t* p, long long v)
+{
+    return my_dlog_u64(p, (unsigned long long)v);
+}
+//long is 32 bits on the target, the size check keeps other ABIs from truncating
+static inline uint32_t* my_dlog_long(uint32_t* p, long v)
+{
+    return (sizeof(v) > sizeof(uint32_t)) ? my_dlog_i64(p, v) : my_dlog_i32(p, (int32_t)v);
+}
+static inline uint32_t* my_dlog_ulong(uint32_t* p, unsigned long v)
+{
+    return (sizeof(v) > sizeof(uint32_t)) ? my_dlog_u64(p, v) : my_dlog_u32(p, (uint32_t)v);
+}
+static inline uint32_t* my_dlog_ptr(uint32_t* p, const void* v)
+{
+    return my_dlog_u32(p, (uint32_t)(uintptr_t)v);
+}
+static inline uint32_t* my_dlog_f32(uint32_t* p, float v)
+{
+    union { float f; uint32_t u; } bits = { .f = v };
+    return my_dlog_u32(p, bits.u);
+}
+static inline uint32_t* my_dlog_f64(uint32_t* p, double v)
+{
+    return my_dlog_f32(p, (float)v);
+}
+uint32_t* my_dlog_unsupported(uint32_t* p, ...)
+    __attribute__(( error("MY_DLOG: unsupported argument type, cast it to one of the types in MY_DLOG_ARG") ));
+#define MY_DLOG_ARG(p, x) _Generic((x), \
+    _Bool: my_dlog_u32, \
+    char: my_dlog_i32, \
+    signed char: my_dlog_i32, \
+    unsigned char: my_dlog_u32, \
+    short: my_dlog_i32, \
+    unsigned short: my_dlog_u32, \
+    int: my_dlog_i32, \
+    unsigned int: my_dlog_u32, \
+    long: my_dlog_long, \
+    unsigned long: my_dlog_ulong, \
+    long long: my_dlog_i64, \
+    unsigned long long: my_dlog_u64, \
+    float: my_dlog_f32, \
+    double: my_dlog_f64, \
+    char*: my_dlog_ptr, \
+    const char*: my_dlog_ptr, \
+    void*: my_dlog_ptr, \
+    const void*: my_dlog_ptr, \
+    default: my_dlog_unsupported)((p), (x))
+
+#define MY_DLOG_NARGS(...) MY_DLOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define MY_DLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define MY_DLOG_CAT(a, b) MY_DLOG_CAT_(a, b)
+#define MY_DLOG_CAT_(a, b) a##b
+#define MY_DLOG_MAP(p, ...) MY_DLOG_CAT(MY_DLOG_MAP_, MY_DLOG_NARGS(__VA_ARGS__))(p, ##__VA_ARGS__)
+#define MY_DLOG_MAP_0(p)
+#define MY_DLOG_MAP_1(p, a) p = MY_DLOG_ARG(p, a);
+#define MY_DLOG_MAP_2(p, a, ...) p = MY_DLOG_ARG(p, a); MY_DLOG_MAP_1(p, __VA_ARGS__)
+#define MY_DLOG_MAP_3(p, a, ...) p = MY_DLOG_ARG(p, a); MY_DLOG_MAP_2(p, __VA_ARGS__)
+#define MY_DLOG_MAP_4(p, a, ...) p = MY_DLOG_ARG(p, a); MY_DLOG_MAP_3(p, __VA_ARGS__)
+#define MY_DLOG_MAP_5(p, a, ...) p = MY_DLOG_ARG(p, a); MY_DLOG_MAP_4(p, __VA_ARGS__)
+#define MY_DLOG_MAP_6(p, a, ...) p = MY_DLOG_ARG(p, a); MY_DLOG_MAP_5(p, __VA_ARGS__)
+#define MY_DLOG_MAP_7(p, a, ...) p = MY_DLOG_ARG(p, a); MY_DLOG_MAP_6(p, __VA_ARGS__)
+#define MY_DLOG_MAP_8(p, a, ...) p = MY_DLOG_ARG(p, a); MY_DLOG_MAP_7(p, __VA_ARGS__)
+
+//Up to two words per argument, the writers inline down to plain stores
+#define MY_DLOG(level, fmt, ...) do { \
+        static const char my_dlog_fmt_[] MY_DLOG_SECTION = fmt; \
+        uint32_t my_dlog_args_[2 * MY_DLOG_MAX_ARGS]; \
+        uint32_t* my_dlog_end_ = my_dlog_args_; \
+        MY_DLOG_MAP(my_dlog_end_, ##__VA_ARGS__) \
+        my_dlog_write((level), (uint32_t)(uintptr_t)my_dlog_fmt_, MY_DLOG_NARGS(__VA_ARGS__) ? my_dlog_args_ : NULL, \
+            (uint32_t)(my_dlog_end_ - my_dlog_args_)); \
+    } while (0)
+
+#else
+
+#define MY_DLOG(level, fmt, ...) do { } while (0)
+static inline HAL_StatusTypeDef my_dlog_init(void) { return HAL_OK; }
+static inline void my_dlog_flush(void) { }
+
+#endif
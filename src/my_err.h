@@ -8,6 +8,7 @@ typedef enum
     MY_ERR_OVERCURRENT,
     MY_ERR_COPROC_TIMEOUT,
     MY_ERR_UNKNOWN,
+    MY_ERR_STACK_OVERFLOW, //Codes are stored in EEPROM, only append
 
     MY_ERR_TOTAL
 } my_err_t;
\ No newline at end of file
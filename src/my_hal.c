@@ -9,6 +9,8 @@
 #include <mik32_hal_scr1_timer.h>
 #include <mik32_hal_spi.h>
 #include "sys_command_line.h"
+#include "my_trace.h"
+#include "my_stack.h"
 
 #define CHECK_ERROR(status, msg) do { HAL_StatusTypeDef s = (status); \
         if (s != HAL_OK) { ret = s; xprintf(msg ", %" PRIu32 "\n", s); } \
@@ -21,45 +23,188 @@ static SPI_HandleTypeDef hspi1 = {};
 static TIMER32_HandleTypeDef htim_main_0 = {};
 static TIMER32_CHANNEL_HandleTypeDef htim_main_0_ch_2 = {};
 static TIMER32_CHANNEL_HandleTypeDef htim_main_0_ch_4 = {};
+static TIMER32_HandleTypeDef htim_ctrl = {};
 static DMA_InitTypeDef hdma;
 static DMA_ChannelHandleTypeDef hdma_ch0;
 static DMA_ChannelHandleTypeDef hdma_ch1;
+static DMA_ChannelHandleTypeDef hdma_ch_uart_rx;
 static volatile uint32_t eeprom_error_stats = 0;
+static my_perf_stat_t irq_latency[MY_IRQ_SRC_TOTAL]; //Cycles from trap entry to the start of servicing
+static my_perf_stat_t trap_time; //Cycles spent in the whole handler
+static uint64_t irq_stats_reset_time = 0; //us
+
+//UART TX ring, filled by xdev_out and drained by the TXE interrupt. Indexes are free-running.
+static uint8_t uart_tx_buf[UART_TX_BUF_SIZE];
+static volatile uint32_t uart_tx_head = 0;
+static volatile uint32_t uart_tx_tail = 0;
+static uart_tx_policy_t uart_tx_policy = UART_TX_POLICY;
+static uart_tx_stats_t uart_tx_stats = {};
+
+//UART RX ring. The DMA has no circular mode: the channel covers the whole buffer and is restarted on completion.
+//Write position = laps * size + DMA destination offset, read position is free-running.
+static uint8_t uart_rx_buf[UART_RX_BUF_SIZE];
+static volatile uint32_t uart_rx_laps = 0;
+static uint32_t uart_rx_tail = 0;
+static uart_rx_stats_t uart_rx_stats = {};
+
+//EPIC dispatch table, indexed by line (my_irq.h)
+static my_irq_table_t irq_table;
+static uint32_t trap_entry = 0; //mcycle at trap entry, traps don't nest
+
+//my_irq_dispatch() hooks, inlined into the trap handler
+static inline __attribute__((always_inline)) void epic_ack(uint32_t lines)
+{
+    EPIC->CLEAR = lines;
+}
+static inline __attribute__((always_inline)) void irq_latency_add(uint32_t source)
+{
+    my_perf_stat_add(&(irq_latency[source]), read_csr(mcycle) - trap_entry);
+}
 
 void RAM_ATTR trap_handler(void)
 {
-    if (EPIC_CHECK_WDT())
-    {
-        GPIO_0->OUTPUT |= GPIO_PIN_10;
-        HAL_EPIC_MaskLevelClear(0xFFFFFFFF);
-        HAL_EPIC_MaskEdgeClear(0xFFFFFFFF);
-        EPIC->CLEAR = 0xFFFFFFFF;
-        while (1);
-    }
-    if (UART_STDOUT_EPIC_CHECK())
+    trap_entry = read_csr(mcycle);
+    my_stack_isr_enter();
+    TRACE_BEGIN(ISR);
+    my_irq_dispatch(&irq_table, EPIC->STATUS, epic_ack, irq_latency_add);
+    TRACE_END(ISR);
+    my_perf_stat_add(&trap_time, read_csr(mcycle) - trap_entry);
+}
+
+static void RAM_ATTR wdt_irq_handler(void)
+{
+    GPIO_0->OUTPUT |= GPIO_PIN_10;
+    HAL_EPIC_MaskLevelClear(0xFFFFFFFF);
+    HAL_EPIC_MaskEdgeClear(0xFFFFFFFF);
+    EPIC->CLEAR = 0xFFFFFFFF;
+    while (1);
+}
+static void RAM_ATTR uart_irq_handler(void)
+{
+#if ENABLE_UART_RX_DMA
+    uint32_t flags = UART_STDOUT->FLAGS & (UART_FLAGS_IDLE_M | UART_FLAGS_ORE_M | UART_FLAGS_PE_M | UART_FLAGS_FE_M);
+    if (flags)
     {
-        if ((UART_STDOUT->FLAGS & UART_FLAGS_RXNE_M) != 0) 
+        UART_STDOUT->FLAGS = flags; //Write 1 to clear
+        if (flags & UART_FLAGS_IDLE_M)
         {
-            unsigned char rx = (unsigned char)(UART_STDOUT->RXDATA);
-            cli_uart_rxcplt_callback(rx);
+            TRACE(UART_RX, 0);
+            uart_rx_stats.idle_events++;
         }
+        if (flags & UART_FLAGS_ORE_M) uart_rx_stats.overruns++;
+        if (flags & UART_FLAGS_PE_M) uart_rx_stats.parity_errors++;
+        if (flags & UART_FLAGS_FE_M) uart_rx_stats.framing_errors++;
     }
-    if (EPIC_CHECK_DMA())
+#else
+    while ((UART_STDOUT->FLAGS & UART_FLAGS_RXNE_M) != 0)
     {
-        HAL_SPI_CS_Enable(&hspi1, SPI_CS_0);
-        HAL_DMA_ClearLocalIrq(&hdma);
+        unsigned char rx = (unsigned char)(UART_STDOUT->RXDATA);
+        TRACE(UART_RX, rx);
+        cli_uart_rxcplt_callback(rx);
     }
-    if (EPIC_CHECK_EEPROM())
+#endif
+    uint32_t tail = uart_tx_tail;
+    while ((tail != uart_tx_head) && ((UART_STDOUT->FLAGS & UART_FLAGS_TXE_M) != 0))
     {
-        ++eeprom_error_stats;
+        UART_STDOUT->TXDATA = uart_tx_buf[tail++ & (UART_TX_BUF_SIZE - 1)];
+        uart_tx_stats.sent++;
     }
-    EPIC->CLEAR = 0xFFFFFFFF;
+    uart_tx_tail = tail;
+    if (tail == uart_tx_head) UART_STDOUT->CONTROL1 &= ~UART_CONTROL1_TXEIE_M;
+}
+static void RAM_ATTR uart_rx_dma_start(void)
+{
+    HAL_DMA_Start(&hdma_ch_uart_rx, (void*)&UART_STDOUT->RXDATA, uart_rx_buf, UART_RX_BUF_SIZE - 1);
+}
+static void RAM_ATTR dma_irq_handler(void)
+{
+    //Local IRQ flags are cleared all at once, sample them first
+    bool spi_done = HAL_DMA_GetChannelIrq(&hdma_ch1);
+#if ENABLE_UART_RX_DMA
+    bool uart_rx_done = HAL_DMA_GetChannelIrq(&hdma_ch_uart_rx);
+#else
+    bool uart_rx_done = false;
+#endif
+    HAL_DMA_ClearLocalIrq(&hdma);
+    TRACE(DMA_IRQ, uart_rx_done);
+    if (uart_rx_done)
+    {
+        uart_rx_laps++;
+        uart_rx_dma_start();
+    }
+    if (spi_done) HAL_SPI_CS_Enable(&hspi1, SPI_CS_0);
+}
+static void RAM_ATTR eeprom_irq_handler(void)
+{
+    TRACE(EEPROM_IRQ, 0);
+    ++eeprom_error_stats;
 }
 
+//Interrupts must be disabled
+static void uart_tx_poll_one(void)
+{
+    while ((UART_STDOUT->FLAGS & UART_FLAGS_TXE_M) == 0);
+    UART_STDOUT->TXDATA = uart_tx_buf[uart_tx_tail++ & (UART_TX_BUF_SIZE - 1)];
+    uart_tx_stats.sent++;
+}
 static void UART_putc(char c)
 {
-    UART_WriteByte(UART_STDOUT, c);
-	UART_WaitTransmission(UART_STDOUT);
+    uint32_t irq_state = my_irq_save();
+    if ((uart_tx_head - uart_tx_tail) >= UART_TX_BUF_SIZE)
+    {
+        if (!(irq_state & MSTATUS_MIE))
+        {
+            //Nobody would drain the buffer (early init, trap context, critical section): push it out ourselves
+            uart_tx_poll_one();
+        }
+        else if (uart_tx_policy == UART_TX_BLOCK)
+        {
+            do
+            {
+                set_csr(mstatus, MSTATUS_MIE);
+                clear_csr(mstatus, MSTATUS_MIE);
+            } while ((uart_tx_head - uart_tx_tail) >= UART_TX_BUF_SIZE);
+        }
+        else if (uart_tx_policy == UART_TX_OVERWRITE)
+        {
+            uart_tx_tail++;
+            uart_tx_stats.dropped++;
+        }
+        else
+        {
+            uart_tx_stats.dropped++;
+            my_irq_restore(irq_state);
+            return;
+        }
+    }
+    uart_tx_buf[uart_tx_head++ & (UART_TX_BUF_SIZE - 1)] = (uint8_t)c;
+    uint32_t used = uart_tx_head - uart_tx_tail;
+    if (used > uart_tx_stats.max_used) uart_tx_stats.max_used = used;
+    UART_STDOUT->CONTROL1 |= UART_CONTROL1_TXEIE_M;
+    my_irq_restore(irq_state);
+}
+//Console output without VT100 sequences (colours, cursor moves), for scripts. Main context only.
+static void UART_putc_plain(char c)
+{
+    static enum { VT_TEXT, VT_ESC, VT_CSI } state = VT_TEXT;
+
+    switch (state)
+    {
+    case VT_ESC:
+        state = (c == '[') ? VT_CSI : VT_TEXT; //Two-byte sequences end here
+        return;
+    case VT_CSI:
+        if ((c >= 0x40) && (c <= 0x7E)) state = VT_TEXT; //Final byte
+        return;
+    default:
+        if (c == '\x1b')
+        {
+            state = VT_ESC;
+            return;
+        }
+        UART_putc(c);
+        return;
+    }
 }
 static PCC_ConfigErrorsTypeDef SystemClock_Config(void)
 {
@@ -164,6 +309,7 @@ static HAL_StatusTypeDef WDT_Init()
     HAL_DelayMs(1); //Required
     CHECK_ERROR(HAL_WDT_Start(&hwdt, WDT_TIMEOUT_DEFAULT), "Failed to start WDT");
     CHECK_ERROR(HAL_WDT_Refresh(&hwdt, WDT_TIMEOUT_DEFAULT), "Failed to refresh WDT");
+    register_irq(EPIC_WDT_INDEX, wdt_irq_handler, MY_IRQ_SRC_WDT);
     HAL_EPIC_MaskEdgeSet(HAL_EPIC_WDT_MASK);
 #endif
     return ret;
@@ -179,13 +325,23 @@ static HAL_StatusTypeDef my_uart_init()
         UART_CONTROL1_PCE_M | //Enable parity check
         UART_CONTROL1_PS_M | //Odd parity
         UART_CONTROL1_M_9BIT_M | //9 bit packet
+#if ENABLE_UART_RX_DMA
+        UART_CONTROL1_IDLEIE_M | //Idle line interrupt
+        UART_CONTROL1_PEIE_M; //Parity error interrupt
+    const uint32_t control_3 =
+        UART_CONTROL3_DMAR_M | //Received data goes to DMA
+        UART_CONTROL3_EIE_M; //Overrun & framing error interrupt
+#else
         UART_CONTROL1_RXNEIE_M; //Received interrupt
+    const uint32_t control_3 = 0;
+#endif
     xdev_out(UART_putc);
-    ret = UART_Init(UART_STDOUT, 32, control_1, 0, 0) ? //1Mbaud
+    ret = UART_Init(UART_STDOUT, 32, control_1, 0, control_3) ? //1Mbaud
         HAL_OK : HAL_ERROR;
 
-    //Setup interrupt receiver buffer
-    HAL_EPIC_MaskEdgeSet(UART_STDOUT_EPIC_MASK);
+    //Setup interrupt receiver and transmitter buffers. TXE is a level condition, so is the line.
+    register_irq(UART_STDOUT_EPIC_LINE, uart_irq_handler, MY_IRQ_SRC_UART);
+    HAL_EPIC_MaskLevelSet(UART_STDOUT_EPIC_MASK);
 
     return ret;
 }
@@ -266,6 +422,32 @@ static void DMA_CH1_Init(DMA_InitTypeDef *hdma)
 
     HAL_DMA_LocalIRQEnable(&hdma_ch1, DMA_IRQ_ENABLE);
 }
+#if ENABLE_UART_RX_DMA
+static void DMA_UART_RX_Init(DMA_InitTypeDef *hdma)
+{
+    hdma_ch_uart_rx.dma = hdma;
+
+    hdma_ch_uart_rx.ChannelInit.Channel = DMA_CHANNEL_2;
+    hdma_ch_uart_rx.ChannelInit.Priority = DMA_CHANNEL_PRIORITY_HIGH;
+
+    hdma_ch_uart_rx.ChannelInit.ReadMode = DMA_CHANNEL_MODE_PERIPHERY;
+    hdma_ch_uart_rx.ChannelInit.ReadInc = DMA_CHANNEL_INC_DISABLE;
+    hdma_ch_uart_rx.ChannelInit.ReadSize = DMA_CHANNEL_SIZE_BYTE;
+    hdma_ch_uart_rx.ChannelInit.ReadBurstSize = 0;
+    hdma_ch_uart_rx.ChannelInit.ReadRequest = UART_STDOUT_DMA_REQUEST;
+    hdma_ch_uart_rx.ChannelInit.ReadAck = DMA_CHANNEL_ACK_DISABLE;
+
+    hdma_ch_uart_rx.ChannelInit.WriteMode = DMA_CHANNEL_MODE_MEMORY;
+    hdma_ch_uart_rx.ChannelInit.WriteInc = DMA_CHANNEL_INC_ENABLE;
+    hdma_ch_uart_rx.ChannelInit.WriteSize = DMA_CHANNEL_SIZE_BYTE;
+    hdma_ch_uart_rx.ChannelInit.WriteBurstSize = 0;
+    hdma_ch_uart_rx.ChannelInit.WriteRequest = UART_STDOUT_DMA_REQUEST;
+    hdma_ch_uart_rx.ChannelInit.WriteAck = DMA_CHANNEL_ACK_DISABLE;
+
+    HAL_DMA_LocalIRQEnable(&hdma_ch_uart_rx, DMA_IRQ_ENABLE);
+    uart_rx_dma_start();
+}
+#endif
 static HAL_StatusTypeDef DMA_Init(void)
 {
     /* Настройки DMA */
@@ -275,6 +457,10 @@ static HAL_StatusTypeDef DMA_Init(void)
     /* Инициализация канала */
     DMA_CH0_Init(&hdma);
     DMA_CH1_Init(&hdma);
+#if ENABLE_UART_RX_DMA
+    DMA_UART_RX_Init(&hdma);
+#endif
+    register_irq(EPIC_DMA_INDEX, dma_irq_handler, MY_IRQ_SRC_DMA);
     HAL_EPIC_MaskLevelSet(HAL_EPIC_DMA_MASK);
     return ret;
 }
@@ -286,6 +472,7 @@ HAL_StatusTypeDef my_hal_init(void)
 
     write_csr(mtvec, RAM_BASE_ADDRESS);
     HAL_Init();
+    register_irq(EPIC_EEPROM_INDEX, eeprom_irq_handler, MY_IRQ_SRC_EEPROM);
     __HAL_PCC_PM_CLK_ENABLE();
     PCC_ConfigErrorsTypeDef clock_errors = SystemClock_Config();
     __HAL_PCC_EPIC_CLK_ENABLE();
@@ -353,6 +540,37 @@ void reset_micros(void)
 {
     __HAL_SCR1_TIMER_SET_TIME(0);
 }
+/**
+ * @brief Wait for an interrupt or until SCR1 time reaches the deadline (us, 32-bit timebase), whichever comes first
+ * @retval Time spent waiting, us (interrupt handlers that ran on wake-up are not included)
+ */
+uint32_t sleep_until(uint32_t deadline)
+{
+    //Keep interrupts from being taken until we're awake again: WFI still wakes up on pending & enabled
+    //sources with MIE cleared, so an interrupt arriving before WFI isn't missed
+    uint32_t irq_state = my_irq_save();
+    uint64_t now = get_micros();
+    int32_t remaining = (int32_t)(deadline - (uint32_t)now);
+    uint32_t slept = 0;
+    if (remaining > 0)
+    {
+#if ENABLE_WFI
+        uint64_t compare = now + (uint32_t)remaining;
+        //Write the high word first so that no intermediate value lies in the past
+        SCR1_TIMER->MTIMECMPH = UINT32_MAX;
+        SCR1_TIMER->MTIMECMP = (uint32_t)compare;
+        SCR1_TIMER->MTIMECMPH = (uint32_t)(compare >> 32);
+        set_csr(mie, MIE_MTIE);
+        __asm__ volatile ("wfi");
+        clear_csr(mie, MIE_MTIE);
+#else
+        while (((int32_t)(deadline - get_micros_32()) > 0) && !(read_csr(mip) & read_csr(mie)));
+#endif
+        slept = get_micros_32() - (uint32_t)now;
+    }
+    my_irq_restore(irq_state);
+    return slept;
+}
 #if ENABLE_JTAG
 HAL_StatusTypeDef wdt_stop(void)
 {
@@ -376,11 +594,13 @@ HAL_StatusTypeDef spi_dummy_transmit(void)
     static uint8_t tx[SPI_DUMMY_SZ] = { 0x00, 0x0B, 0x0A, 0x0D, 0x0F, 0x00, 0x00, 0x0D };
     static uint8_t rx[SPI_DUMMY_SZ];
 
+    TRACE_BEGIN(SPI_XFER);
     HAL_SPI_CS_Disable(&hspi1);
     HAL_DMA_Start(&hdma_ch0, tx, (void*)&hspi1.Instance->TXDATA, SPI_DUMMY_SZ - 1);
     HAL_DMA_Start(&hdma_ch1, (void *)&hspi1.Instance->RXDATA, rx, SPI_DUMMY_SZ - 1);
     HAL_DMA_Wait(&hdma_ch0, DMA_TIMEOUT_DEFAULT);
     HAL_DMA_Wait(&hdma_ch1, DMA_TIMEOUT_DEFAULT);
+    TRACE_END(SPI_XFER);
 
     return HAL_OK;
 }
@@ -405,7 +625,164 @@ uint32_t get_eeprom_error_stats(void)
 {
     return eeprom_error_stats;
 }
+/**
+ * @brief Install the trap handler callback for an EPIC line. Unmasking the line is up to the caller.
+ */
+HAL_StatusTypeDef register_irq(uint32_t epic_line, irq_handler_t handler, my_irq_source_t source)
+{
+    if ((epic_line >= EPIC_LINE_COUNT) || (source >= MY_IRQ_SRC_TOTAL)) return HAL_ASSERTION_FAILED;
+    return my_irq_register(&irq_table, epic_line, handler, source) ? HAL_OK : HAL_ASSERTION_FAILED;
+}
+/**
+ * @brief Start the control tick timer (separate from the PWM timers), handler is called on every overflow
+ */
+HAL_StatusTypeDef start_ctrl_timer(uint32_t period_us, irq_handler_t handler)
+{
+    HAL_StatusTypeDef ret = HAL_OK;
 
+    htim_ctrl.Instance = CTRL_TIMER;
+    htim_ctrl.Top = period_us * (OSC_SYSTEM_VALUE / 1000000u) - 1;
+    htim_ctrl.State = TIMER32_STATE_DISABLE;
+    htim_ctrl.Clock.Source = TIMER32_SOURCE_PRESCALER;
+    htim_ctrl.Clock.Prescaler = 0;
+    htim_ctrl.InterruptMask = TIMER32_INT_OVERFLOW_M;
+    htim_ctrl.CountMode = TIMER32_COUNTMODE_FORWARD;
+    CHECK_ERROR(HAL_Timer32_Init(&htim_ctrl), "Control timer init failed");
+    if (ret != HAL_OK) return ret;
+    CHECK_ERROR(register_irq(CTRL_TIMER_EPIC_LINE, handler, MY_IRQ_SRC_CTRL), "Control timer IRQ registration failed");
+    if (ret != HAL_OK) return ret;
+
+    HAL_Timer32_Value_Clear(&htim_ctrl);
+    clear_ctrl_timer_irq();
+    HAL_EPIC_MaskLevelSet(_BV(CTRL_TIMER_EPIC_LINE));
+    HAL_Timer32_Start(&htim_ctrl);
+    return ret;
+}
+uint32_t get_spurious_irq_count(void)
+{
+    return irq_table.spurious;
+}
+//Stats are updated by the trap handler, take consistent snapshots
+void get_irq_stats(my_irq_source_t src, my_perf_stat_t* latency)
+{
+    uint32_t irq_state = my_irq_save();
+    *latency = irq_latency[src];
+    my_irq_restore(irq_state);
+}
+/**
+ * @retval Microseconds elapsed since the last reset
+ */
+uint64_t get_trap_stats(my_perf_stat_t* handler_time)
+{
+    uint32_t irq_state = my_irq_save();
+    *handler_time = trap_time;
+    my_irq_restore(irq_state);
+    return get_time_past(irq_stats_reset_time);
+}
+void reset_irq_stats(void)
+{
+    uint32_t irq_state = my_irq_save();
+    for (size_t i = 0; i < MY_IRQ_SRC_TOTAL; i++) my_perf_stat_reset(&(irq_latency[i]));
+    my_perf_stat_reset(&trap_time);
+    irq_stats_reset_time = get_micros();
+    my_irq_restore(irq_state);
+}
+void set_uart_tx_policy(uart_tx_policy_t policy)
+{
+    uart_tx_policy = policy;
+}
+/**
+ * @brief Strip VT100 sequences from xprintf output (uart_write() is not affected)
+ */
+void set_uart_plain_output(bool plain)
+{
+    xdev_out(plain ? UART_putc_plain : UART_putc);
+}
+/**
+ * @brief Queue raw bytes for transmission, bypassing xprintf
+ */
+void uart_write(const void* data, size_t len)
+{
+    const char* p = data;
+    while (len--) UART_putc(*p++);
+}
+/**
+ * @brief Wait until everything queued has left the wire. Call before a reset or a hang.
+ */
+void uart_tx_flush(void)
+{
+    uint32_t irq_state = my_irq_save();
+    while (uart_tx_tail != uart_tx_head) uart_tx_poll_one();
+    UART_STDOUT->CONTROL1 &= ~UART_CONTROL1_TXEIE_M;
+    while ((UART_STDOUT->FLAGS & UART_FLAGS_TC_M) == 0);
+    my_irq_restore(irq_state);
+}
+void get_uart_tx_stats(uart_tx_stats_t* stats)
+{
+    uint32_t irq_state = my_irq_save();
+    *stats = uart_tx_stats;
+    my_irq_restore(irq_state);
+}
+void reset_uart_tx_stats(void)
+{
+    uint32_t irq_state = my_irq_save();
+    uart_tx_stats = (uart_tx_stats_t){ 0 };
+    my_irq_restore(irq_state);
+}
+
+#if ENABLE_UART_RX_DMA
+//Write position of the RX DMA, see uart_rx_laps
+static uint32_t uart_rx_head(void)
+{
+    uint32_t laps, offset;
+    do
+    {
+        laps = uart_rx_laps;
+        offset = hdma.Instance->CHANNELS[DMA_CHANNEL_2].DST - (uintptr_t)uart_rx_buf;
+    } while (laps != uart_rx_laps);
+    return laps * UART_RX_BUF_SIZE + offset;
+}
+#endif
+/**
+ * @brief Take up to len received bytes out of the RX buffer. Bytes that aren't taken stay buffered,
+ * until the DMA comes around and overwrites them (counted as dropped).
+ * @retval Number of bytes copied
+ */
+size_t uart_rx_read(uint8_t* buf, size_t len)
+{
+#if ENABLE_UART_RX_DMA
+    uint32_t head = uart_rx_head();
+    uint32_t available = head - uart_rx_tail;
+    if (available > UART_RX_BUF_SIZE)
+    {
+        //Lapped by the DMA: the oldest data is gone, keep what is still intact
+        uart_rx_stats.dropped += available - UART_RX_BUF_SIZE;
+        uart_rx_tail = head - UART_RX_BUF_SIZE;
+        available = UART_RX_BUF_SIZE;
+    }
+    if (len > available) len = available;
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = uart_rx_buf[uart_rx_tail++ & (UART_RX_BUF_SIZE - 1)];
+    }
+    uart_rx_stats.received += len;
+    return len;
+#else
+    return 0;
+#endif
+}
+void get_uart_rx_stats(uart_rx_stats_t* stats)
+{
+    uint32_t irq_state = my_irq_save();
+    *stats = uart_rx_stats;
+    my_irq_restore(irq_state);
+}
+void reset_uart_rx_stats(void)
+{
+    uint32_t irq_state = my_irq_save();
+    uart_rx_stats = (uart_rx_stats_t){ 0 };
+    my_irq_restore(irq_state);
+}
 #if !ENABLE_WDT
 HAL_StatusTypeDef wdt_start(void)
 {
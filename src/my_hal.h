@@ -10,19 +10,31 @@
 #include <mik32_hal_scr1_timer.h>
 #include <uart.h>
 
+#include "my_irq.h"
+#include "my_perf.h"
+#include "my_types.h"
+
 #define MY_FIRMWARE_INFO_STR "fw_eeprom-v0.1"
 
 #define ENABLE_WDT 0
+#define ENABLE_UART_RX_DMA 1 //Receive console input by DMA instead of a per-byte interrupt
+#define ENABLE_WFI 1 //Sleep in the idle loop (disable if it gets in the way of the debugger)
+#define ENABLE_STACK_CANARY 1 //Check the bottom of the stack every main loop pass, see my_stack.h
 
 #define PWM_TOP 16000
 #define UART_STDOUT UART_1
-#define UART_STDOUT_EPIC_MASK EPIC_UART_1_INDEX
+#define UART_STDOUT_EPIC_LINE EPIC_UART_1_INDEX
+#define UART_STDOUT_EPIC_MASK _BV(UART_STDOUT_EPIC_LINE)
 #define UART_STDOUT_EPIC_CHECK() EPIC_CHECK_UART_1()
+#define UART_STDOUT_DMA_REQUEST DMA_CHANNEL_USART_1_REQUEST
 #define UART_BUF_SIZE 128
-#define MAIN_MOTOR_COUNT 2
-#define AUX_MOTOR_COUNT 4
-#define TOTAL_MOTOR_COUNT (MAIN_MOTOR_COUNT + AUX_MOTOR_COUNT)
+#define UART_TX_BUF_SIZE 512 //Power of 2
+#define UART_RX_BUF_SIZE 1024 //Power of 2, ~10ms at 1Mbaud
+#define UART_TX_POLICY UART_TX_BLOCK //What to do when the TX buffer is full
 #define HAL_ASSERTION_FAILED 0x04
+#define EPIC_LINE_COUNT MY_IRQ_LINE_COUNT
+#define CTRL_TIMER TIMER32_2
+#define CTRL_TIMER_EPIC_LINE EPIC_TIMER32_2_INDEX
 
 #define _BV(bit) (1u << (bit))
 #define RAM_ATTR __attribute__( ( noinline, section(".ram_text") ) )
@@ -37,19 +49,35 @@ enum
 } typedef motor_t;
 typedef enum
 {
-    MOTOR_CW = 0,
-    MOTOR_CCW
-} direction_t;
-struct _soft_timer
+    MY_IRQ_SRC_WDT = 0,
+    MY_IRQ_SRC_UART,
+    MY_IRQ_SRC_DMA,
+    MY_IRQ_SRC_EEPROM,
+    MY_IRQ_SRC_CTRL,
+
+    MY_IRQ_SRC_TOTAL
+} my_irq_source_t;
+typedef enum
+{
+    UART_TX_DROP = 0, //Discard the new byte
+    UART_TX_BLOCK, //Wait for the interrupt to make room
+    UART_TX_OVERWRITE //Discard the oldest queued byte
+} uart_tx_policy_t;
+typedef struct
 {
-    uint32_t interval; //us
-    uint32_t last_time;
-} typedef soft_timer;
-struct _soft_timer_32
+    uint32_t sent;
+    uint32_t dropped;
+    uint32_t max_used; //Buffer high-water mark, bytes
+} uart_tx_stats_t;
+typedef struct
 {
-    uint32_t interval; //us
-    uint32_t last_time;
-} typedef soft_timer_32;
+    uint32_t received;
+    uint32_t dropped; //Overwritten by DMA before being read
+    uint32_t overruns; //Lost by the UART itself
+    uint32_t parity_errors;
+    uint32_t framing_errors;
+    uint32_t idle_events; //Idle-line chunk boundaries
+} uart_rx_stats_t;
 
 HAL_StatusTypeDef my_hal_init(void);
 void delay_us(uint64_t us);
@@ -58,26 +86,51 @@ void toggle_green_led(void);
 HAL_StatusTypeDef spi_dummy_transmit(void);
 HAL_StatusTypeDef set_pwm_duty(motor_t ch, uint16_t duty);
 uint32_t get_eeprom_error_stats(void);
+HAL_StatusTypeDef register_irq(uint32_t epic_line, irq_handler_t handler, my_irq_source_t source);
+uint32_t get_spurious_irq_count(void);
+void get_irq_stats(my_irq_source_t src, my_perf_stat_t* latency);
+uint64_t get_trap_stats(my_perf_stat_t* handler_time);
+void reset_irq_stats(void);
+void set_uart_tx_policy(uart_tx_policy_t policy);
+void set_uart_plain_output(bool plain);
+void uart_write(const void* data, size_t len);
+void uart_tx_flush(void);
+void get_uart_tx_stats(uart_tx_stats_t* stats);
+void reset_uart_tx_stats(void);
+size_t uart_rx_read(uint8_t* buf, size_t len);
+void get_uart_rx_stats(uart_rx_stats_t* stats);
+void reset_uart_rx_stats(void);
 
-inline uint64_t get_micros(void)
+//Always inlined, interrupt handlers in RAM use them
+static inline __attribute__(( always_inline )) uint64_t get_micros(void)
 {
     return __HAL_SCR1_TIMER_GET_TIME();
 }
-inline uint32_t get_micros_32(void)
+static inline __attribute__(( always_inline )) uint32_t get_micros_32(void)
 {
     return SCR1_TIMER->MTIME;
 }
-inline uint32_t get_time_past_32(uint32_t from)
+static inline uint32_t get_time_past_32(uint32_t from)
 {
     return get_micros_32() - from;
 }
-inline uint64_t get_time_past(uint64_t from)
+static inline uint64_t get_time_past(uint64_t from)
 {
     return get_micros() - from;
 }
+static inline void clear_ctrl_timer_irq(void)
+{
+    CTRL_TIMER->INT_CLEAR = TIMER32_INT_OVERFLOW_M;
+}
+static inline bool is_ctrl_timer_irq_pending(void)
+{
+    return (CTRL_TIMER->INT_FLAGS & TIMER32_INT_OVERFLOW_M) != 0;
+}
+HAL_StatusTypeDef start_ctrl_timer(uint32_t period_us, irq_handler_t handler);
 bool check_soft_timer(soft_timer* t);
 bool check_soft_timer_32(soft_timer_32* t);
 void reset_micros(void);
+uint32_t sleep_until(uint32_t deadline);
 void __attribute__(( optimize("O3") )) wdt_reset(void);
 #if !ENABLE_WDT
 HAL_StatusTypeDef wdt_start(void);
@@ -0,0 +1,64 @@
+#include "my_idle.h"
+
+#include "my_hal.h"
+#include "my_sched.h"
+
+static my_idle_stats_t stats = {};
+static uint32_t window_start = 0;
+static uint32_t window_idle = 0;
+
+/**
+ * PRIVATE API
+ */
+
+static void update_window(uint32_t now)
+{
+    uint32_t elapsed = now - window_start;
+    if (elapsed < MY_IDLE_WINDOW_US) return;
+    stats.load_permille = window_idle < elapsed ? (uint32_t)(1000u - ((uint64_t)window_idle * 1000u) / elapsed) : 0;
+    stats.total_us += elapsed;
+    window_start = now;
+    window_idle = 0;
+}
+
+/**
+ * PUBLIC API
+ */
+
+void my_idle_init(void)
+{
+    stats = (my_idle_stats_t){ 0 };
+    window_start = get_micros_32();
+    window_idle = 0;
+}
+/**
+ * @brief Call at the end of each main loop pass: sleeps until the next scheduler deadline or an interrupt
+ */
+void my_idle(void)
+{
+    uint32_t now = get_micros_32();
+    uint32_t deadline;
+
+    if (!my_sched_get_next_deadline(&deadline) || ((int32_t)(deadline - now) > MY_IDLE_MAX_SLEEP_US))
+    {
+        deadline = now + MY_IDLE_MAX_SLEEP_US;
+    }
+    if ((int32_t)(deadline - now) >= MY_IDLE_MIN_SLEEP_US)
+    {
+        uint32_t slept = sleep_until(deadline);
+        window_idle += slept;
+        stats.idle_us += slept;
+        stats.sleeps++;
+    }
+    update_window(get_micros_32());
+}
+void my_idle_get_stats(my_idle_stats_t* out)
+{
+    *out = stats;
+    //Include the current partial window in the totals
+    out->total_us += get_micros_32() - window_start;
+}
+void my_idle_reset_stats(void)
+{
+    my_idle_init();
+}
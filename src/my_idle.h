@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+#define MY_IDLE_MAX_SLEEP_US 100000 //Upper bound, so the loop (WDT refresh) runs even with no tasks due
+#define MY_IDLE_MIN_SLEEP_US 20 //Not worth the compare setup below this
+#define MY_IDLE_WINDOW_US 1000000 //CPU load averaging window
+
+typedef struct
+{
+    uint64_t idle_us; //Since reset
+    uint64_t total_us;
+    uint32_t sleeps;
+    uint32_t load_permille; //Busy share over the last complete window
+} my_idle_stats_t;
+
+void my_idle_init(void);
+void my_idle(void);
+void my_idle_get_stats(my_idle_stats_t* stats);
+void my_idle_reset_stats(void);
@@ -0,0 +1,20 @@
+#include "my_irq.h"
+
+#include <stddef.h>
+
+/**
+ * PUBLIC API
+ */
+
+/**
+ * @brief Install the handler for a line, replacing any previous one. Only while the line is masked.
+ * @retval false for a line out of range or a NULL handler
+ */
+bool my_irq_register(my_irq_table_t* table, uint32_t line, irq_handler_t handler, uint32_t source)
+{
+    if ((line >= MY_IRQ_LINE_COUNT) || !handler) return false;
+    table->entries[line].source = source;
+    table->entries[line].handler = handler;
+    table->registered |= 1u << line;
+    return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <mik32_hal.h>
+
+#ifndef MY_IRQ_LINE_COUNT
+#define MY_IRQ_LINE_COUNT 32
+#endif
+
+/*
+ * Interrupt controller dispatch, independent of the EPIC registers so the host tests can drive it.
+ * Handlers are registered per line; my_irq_dispatch() services the lines latched when the trap was taken,
+ * lowest line first, acknowledging each one right before its handler runs. An event that arrives meanwhile
+ * (on any line, the one being serviced included) latches again and re-enters the trap instead of being lost.
+ * Latched lines without a handler are acknowledged all at once and counted as spurious.
+ */
+
+typedef void (*irq_handler_t)(void);
+
+typedef struct
+{
+    irq_handler_t handler;
+    uint32_t source; //Statistics slot, passed to the enter hook
+} my_irq_entry_t;
+
+typedef struct
+{
+    my_irq_entry_t entries[MY_IRQ_LINE_COUNT];
+    uint32_t registered; //Mask of the lines with a handler
+    volatile uint32_t spurious;
+} my_irq_table_t;
+
+bool my_irq_register(my_irq_table_t* table, uint32_t line, irq_handler_t handler, uint32_t source);
+
+/**
+ * @brief Critical section: masks interrupts and returns the previous state for my_irq_restore(), so a section
+ * entered with interrupts already off (nested, trap context, early init) leaves them off
+ */
+static inline __attribute__((always_inline)) uint32_t my_irq_save(void)
+{
+    return clear_csr(mstatus, MSTATUS_MIE);
+}
+static inline __attribute__((always_inline)) void my_irq_restore(uint32_t state)
+{
+    if (state & MSTATUS_MIE) set_csr(mstatus, MSTATUS_MIE);
+}
+//Lowest set bit of a non-zero mask. Not __builtin_ctz(), that is a libgcc call (flash) on RV32IMC.
+static inline __attribute__((always_inline)) uint32_t my_irq_lowest_line(uint32_t pending)
+{
+    uint32_t line = 0;
+    for (uint32_t step = 16; step > 0; step /= 2)
+    {
+        if ((pending & ((1u << step) - 1u)) == 0)
+        {
+            line += step;
+            pending >>= step;
+        }
+    }
+    return line;
+}
+
+/**
+ * @brief One trap's worth of servicing. Inlined into the trap handler together with the hooks.
+ * @param status Lines latched at trap entry
+ * @param ack Clears latched lines (write-1-to-clear mask)
+ * @param enter Called right before each handler with its source, e.g. for latency stats; may be NULL
+ */
+static inline __attribute__((always_inline)) void my_irq_dispatch(my_irq_table_t* table, uint32_t status,
+    void (*ack)(uint32_t lines), void (*enter)(uint32_t source))
+{
+    uint32_t pending = status & table->registered;
+
+    //Lines without a handler can't be serviced, drop them so they don't retrigger forever
+    if (status & ~(table->registered))
+    {
+        table->spurious++;
+        ack(status & ~(table->registered));
+    }
+    while (pending)
+    {
+        uint32_t line = my_irq_lowest_line(pending);
+        uint32_t bit = 1u << line;
+        const my_irq_entry_t* item = &(table->entries[line]);
+        pending &= ~bit;
+        //Acknowledge before servicing: an event arriving meanwhile latches again instead of being lost
+        ack(bit);
+        if (enter) enter(item->source);
+        item->handler();
+    }
+}
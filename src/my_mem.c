@@ -0,0 +1,161 @@
+#include "my_mem.h"
+#include "my_irq.h"
+
+#include <xprintf.h>
+
+extern char __heap_start[];
+extern char __heap_end[];
+
+static my_arena_t* arenas[MY_MEM_MAX_ARENAS];
+static size_t arena_count = 0;
+static my_pool_t* pools[MY_MEM_MAX_POOLS];
+static size_t pool_count = 0;
+static bool sealed = false;
+static size_t heap_used = 0; //Handed out by _sbrk()
+static uint32_t heap_failures = 0;
+
+/**
+ * PUBLIC API
+ */
+
+/**
+ * @brief Register the arena for the report, or release everything in it if it already is (the owner is re-initialized)
+ */
+HAL_StatusTypeDef my_arena_init(my_arena_t* arena)
+{
+    for (size_t i = 0; i < arena_count; i++)
+    {
+        if (arenas[i] != arena) continue;
+        my_arena_reset(arena);
+        return HAL_OK;
+    }
+    if (arena_count >= MY_MEM_MAX_ARENAS) return HAL_ERROR;
+    arena->used = 0;
+    arenas[arena_count++] = arena;
+    return HAL_OK;
+}
+/**
+ * @return NULL when the arena is out of space (counted as a failure)
+ */
+void* my_arena_alloc(my_arena_t* arena, size_t size)
+{
+    void* ptr = NULL;
+
+    size = MY_MEM_ALIGN(size);
+    uint32_t irq_state = my_irq_save();
+    if (size > (arena->size - arena->used)) arena->failures++;
+    else
+    {
+        ptr = &(arena->base[arena->used]);
+        arena->used += size;
+        if (arena->used > arena->high_water) arena->high_water = arena->used;
+    }
+    my_irq_restore(irq_state);
+    return ptr;
+}
+/**
+ * @brief Everything allocated from the arena so far is released, the high-water mark stays
+ */
+void my_arena_reset(my_arena_t* arena)
+{
+    arena->used = 0;
+}
+
+/**
+ * @brief Register the pool for the report and put all its blocks on the free list; a registered pool is only refilled
+ */
+HAL_StatusTypeDef my_pool_init(my_pool_t* pool)
+{
+    bool registered = false;
+    for (size_t i = 0; i < pool_count; i++) registered = registered || (pools[i] == pool);
+    if (!registered && (pool_count >= MY_MEM_MAX_POOLS)) return HAL_ERROR;
+    pool->free_list = NULL;
+    for (size_t i = pool->block_count; i > 0; i--) //Lowest block first out
+    {
+        void** block = (void**)&(pool->storage[(i - 1) * pool->block_size]);
+        *block = pool->free_list;
+        pool->free_list = block;
+    }
+    pool->used = 0;
+    if (!registered) pools[pool_count++] = pool;
+    return HAL_OK;
+}
+/**
+ * @return NULL when the pool is exhausted (counted as a failure)
+ */
+void* my_pool_alloc(my_pool_t* pool)
+{
+    uint32_t irq_state = my_irq_save();
+    void** block = pool->free_list;
+    if (block)
+    {
+        pool->free_list = *block;
+        pool->used++;
+        if (pool->used > pool->high_water) pool->high_water = pool->used;
+    }
+    else pool->failures++;
+    my_irq_restore(irq_state);
+    return block;
+}
+/**
+ * @retval HAL_ERROR for a pointer that isn't the start of one of the pool's blocks, or with no block handed out
+ */
+HAL_StatusTypeDef my_pool_free(my_pool_t* pool, void* block)
+{
+    size_t offset = (uint8_t*)block - pool->storage;
+    if (((uint8_t*)block < pool->storage) || (offset >= (pool->block_size * pool->block_count)) ||
+        ((offset % pool->block_size) != 0)) return HAL_ERROR;
+    HAL_StatusTypeDef status = HAL_ERROR;
+    uint32_t irq_state = my_irq_save();
+    if (pool->used > 0)
+    {
+        *(void**)block = pool->free_list;
+        pool->free_list = block;
+        pool->used--;
+        status = HAL_OK;
+    }
+    my_irq_restore(irq_state);
+    return status;
+}
+
+/**
+ * @brief End of boot: from now on newlib can't grow the heap
+ */
+void my_mem_seal(void)
+{
+    sealed = true;
+}
+/**
+ * @brief _sbrk() gate and accounting, a call after my_mem_seal() is a bug and gets printed with its size
+ */
+bool my_mem_sbrk_allowed(ptrdiff_t incr)
+{
+    if (sealed || (incr > (ptrdiff_t)((size_t)(__heap_end - __heap_start) - heap_used)))
+    {
+        heap_failures++;
+        xprintf("\n!!! sbrk(%" PRId32 ") %s !!!\n", (int32_t)incr, sealed ? "after boot" : "out of heap");
+        return false;
+    }
+    heap_used += incr;
+    return true;
+}
+void my_mem_report(void)
+{
+    xprintf("Heap (sbrk): %" PRIu32 " of %" PRIu32 " bytes, %" PRIu32 " failures, %s\n",
+        (uint32_t)heap_used, (uint32_t)(__heap_end - __heap_start), heap_failures, sealed ? "sealed" : "open");
+    xputs("Arena\tSize\tUsed\tHigh\tFails\n");
+    for (size_t i = 0; i < arena_count; i++)
+    {
+        const my_arena_t* a = arenas[i];
+        xprintf("%s\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\n",
+            a->name, (uint32_t)(a->size), (uint32_t)(a->used), (uint32_t)(a->high_water), a->failures);
+    }
+    xputs("Pool\tBlock\tCount\tUsed\tHigh\tFails\n");
+    for (size_t i = 0; i < pool_count; i++)
+    {
+        const my_pool_t* p = pools[i];
+        xprintf("%s\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\n",
+            p->name, (uint32_t)(p->block_size), (uint32_t)(p->block_count), (uint32_t)(p->used),
+            (uint32_t)(p->high_water), p->failures);
+    }
+}
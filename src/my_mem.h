@@ -0,0 +1,66 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mik32_hal.h>
+
+#define MY_MEM_MAX_ARENAS 4
+#define MY_MEM_MAX_POOLS 4
+
+/*
+ * Deterministic memory: no general-purpose heap after boot.
+ * Arena: a subsystem's fixed budget, carved up with my_arena_alloc() (bump pointer, 4-byte aligned) by the
+ * subsystem's init, released only all at once with my_arena_reset() or by initializing it again.
+ * Allocation is safe from interrupt context, but the intended use is init-time only.
+ * MY_MEM_ALIGN() sizes an arena budget from its allocations, each one is rounded up to a word.
+ * Pool: fixed-size blocks, O(1) my_pool_alloc()/my_pool_free() through a free list, safe from interrupt context.
+ * Arenas and pools keep high-water marks and failure counts for the "mem" command; init registers them for it.
+ * newlib's _sbrk() keeps working until my_mem_seal() (end of boot), afterwards every call fails and is reported.
+ */
+#define MY_MEM_ALIGN(bytes) ((((size_t)(bytes)) + 3u) & ~(size_t)3u)
+#define MY_ARENA(var, arena_name, bytes) \
+    static uint32_t var##_storage[((bytes) + 3u) / 4u]; \
+    static my_arena_t var = { .name = (arena_name), .base = (uint8_t*)(var##_storage), .size = sizeof(var##_storage) }
+#define MY_POOL_BLOCK_SIZE(block_bytes) MY_MEM_ALIGN(block_bytes)
+#define MY_POOL(var, pool_name, block_bytes, blocks) \
+    _Static_assert(MY_POOL_BLOCK_SIZE(block_bytes) >= sizeof(void*), #var ": blocks have to fit a free list link"); \
+    static uint32_t var##_storage[MY_POOL_BLOCK_SIZE(block_bytes) / 4u * (blocks)]; \
+    static my_pool_t var = { .name = (pool_name), .storage = (uint8_t*)(var##_storage), \
+        .block_size = MY_POOL_BLOCK_SIZE(block_bytes), .block_count = (blocks) }
+
+typedef struct
+{
+    const char* name;
+    uint8_t* base;
+    size_t size;
+    size_t used;
+    size_t high_water;
+    uint32_t failures;
+} my_arena_t;
+
+typedef struct
+{
+    const char* name;
+    uint8_t* storage;
+    size_t block_size;
+    size_t block_count;
+    void* free_list;
+    size_t used;
+    size_t high_water;
+    uint32_t failures;
+} my_pool_t;
+
+HAL_StatusTypeDef my_arena_init(my_arena_t* arena);
+void* my_arena_alloc(my_arena_t* arena, size_t size);
+void my_arena_reset(my_arena_t* arena);
+
+HAL_StatusTypeDef my_pool_init(my_pool_t* pool);
+void* my_pool_alloc(my_pool_t* pool);
+HAL_StatusTypeDef my_pool_free(my_pool_t* pool, void* block);
+
+void my_mem_seal(void);
+bool my_mem_sbrk_allowed(ptrdiff_t incr);
+void my_mem_report(void);
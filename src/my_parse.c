@@ -0,0 +1,261 @@
+#include "my_parse.h"
+
+#include <stdbool.h>
+#include <float.h>
+
+#define MAX_SIGNIFICANT_DIGITS 19 //Still fits a uint64_t, twice what a float can tell apart
+#define MAX_EXPONENT 1000 //Anything beyond is out of float range regardless of the mantissa
+#define MAX_EXPONENT_F (FLT_MAX_10_EXP) //Even a mantissa of 1 overflows above it
+#define MIN_EXPONENT_F (FLT_MIN_10_EXP - MAX_SIGNIFICANT_DIGITS - 1) //Even 19 nines underflow below it
+#define MAX_Q_FRAC_DIGITS 32 //frac_bits + 1 digits decide the rounding, see my_parse_q()
+
+static const float pow10_f[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f }; //All exact
+static const double pow10_d[] = { //All exact
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#define POW10_D_MAX ((int32_t)(sizeof(pow10_d) / sizeof(pow10_d[0])) - 1)
+static const char* const err_names[MY_PARSE_ERR_TOTAL] = {
+    [MY_PARSE_OK] = "OK",
+    [MY_PARSE_EMPTY] = "empty",
+    [MY_PARSE_SYNTAX] = "not a number",
+    [MY_PARSE_RANGE] = "out of range"
+};
+
+/**
+ * PRIVATE API
+ */
+
+static uint32_t digit_value(char c)
+{
+    if ((c >= '0') && (c <= '9')) return c - '0';
+    if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+    if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+    return UINT32_MAX;
+}
+static bool parse_sign(const char** p)
+{
+    if (**p == '-')
+    {
+        (*p)++;
+        return true;
+    }
+    if (**p == '+') (*p)++;
+    return false;
+}
+static uint32_t parse_prefix(const char** p)
+{
+    if (((*p)[0] == '0') && (((*p)[1] == 'x') || ((*p)[1] == 'X')))
+    {
+        *p += 2;
+        return 16;
+    }
+    if (((*p)[0] == '0') && (((*p)[1] == 'b') || ((*p)[1] == 'B')))
+    {
+        *p += 2;
+        return 2;
+    }
+    return 10;
+}
+/**
+ * @brief Unsigned digits up to the end of the string
+ */
+static my_parse_err_t parse_digits(const char* p, uint32_t base, uint32_t* val)
+{
+    uint32_t acc = 0;
+    bool overflow = false;
+
+    if (*p == '\0') return MY_PARSE_SYNTAX;
+    for (; *p != '\0'; p++)
+    {
+        uint32_t d = digit_value(*p);
+        if (d >= base) return MY_PARSE_SYNTAX;
+        if (acc > ((UINT32_MAX - d) / base)) overflow = true; //Keep going, a syntax error takes precedence
+        acc = acc * base + d;
+    }
+    if (overflow) return MY_PARSE_RANGE;
+    *val = acc;
+    return MY_PARSE_OK;
+}
+static my_parse_err_t apply_sign(uint32_t magnitude, bool negative, int32_t* val)
+{
+    if (negative)
+    {
+        if (magnitude > (uint32_t)INT32_MAX + 1u) return MY_PARSE_RANGE;
+        *val = (int32_t)(0u - magnitude);
+    }
+    else
+    {
+        if (magnitude > (uint32_t)INT32_MAX) return MY_PARSE_RANGE;
+        *val = (int32_t)magnitude;
+    }
+    return MY_PARSE_OK;
+}
+
+/**
+ * PUBLIC API
+ */
+
+/**
+ * @brief Decimal, 0x hex or 0b binary
+ */
+my_parse_err_t my_parse_u32(const char* str, uint32_t* val)
+{
+    if (*str == '\0') return MY_PARSE_EMPTY;
+    uint32_t base = parse_prefix(&str);
+    return parse_digits(str, base, val);
+}
+/**
+ * @brief Optional sign, then anything my_parse_u32() takes
+ */
+my_parse_err_t my_parse_i32(const char* str, int32_t* val)
+{
+    uint32_t magnitude;
+    my_parse_err_t ret;
+
+    if (*str == '\0') return MY_PARSE_EMPTY;
+    bool negative = parse_sign(&str);
+    uint32_t base = parse_prefix(&str);
+    if ((ret = parse_digits(str, base, &magnitude)) != MY_PARSE_OK) return ret;
+    return apply_sign(magnitude, negative, val);
+}
+/**
+ * @brief Hex with or without the 0x prefix
+ */
+my_parse_err_t my_parse_hex(const char* str, uint32_t* val)
+{
+    if (*str == '\0') return MY_PARSE_EMPTY;
+    if ((str[0] == '0') && ((str[1] == 'x') || (str[1] == 'X'))) str += 2;
+    return parse_digits(str, 16, val);
+}
+/**
+ * @brief [+-]digits[.digits][e[+-]digits], no inf/nan, normal floats only (FLT_MIN..FLT_MAX, or zero).
+ * The first 19 significant digits count. A mantissa up to 2^24 with a decimal exponent within +-10 (most console
+ * input) takes one exact float operation and is correctly rounded. Anything else is scaled in double with at most
+ * four roundings: the float result is then correctly rounded unless the input lies within ~2^-51 (relative) of a
+ * point halfway between two floats, where it can be 1 ULP off. test/test_parse compares it against strtof().
+ */
+my_parse_err_t my_parse_float(const char* str, float* val)
+{
+    uint64_t mantissa = 0;
+    uint32_t significant = 0;
+    int32_t exponent = 0;
+    bool any_digits = false;
+
+    if (*str == '\0') return MY_PARSE_EMPTY;
+    bool negative = parse_sign(&str);
+    for (; (*str >= '0') && (*str <= '9'); str++)
+    {
+        any_digits = true;
+        if (significant < MAX_SIGNIFICANT_DIGITS)
+        {
+            mantissa = mantissa * 10u + (*str - '0');
+            if (mantissa) significant++;
+        }
+        else exponent++; //Dropped digit, keep the magnitude
+    }
+    if (*str == '.')
+    {
+        for (str++; (*str >= '0') && (*str <= '9'); str++)
+        {
+            any_digits = true;
+            if (significant < MAX_SIGNIFICANT_DIGITS)
+            {
+                mantissa = mantissa * 10u + (*str - '0');
+                if (mantissa) significant++;
+                exponent--;
+            }
+        }
+    }
+    if (!any_digits) return MY_PARSE_SYNTAX;
+    if ((*str == 'e') || (*str == 'E'))
+    {
+        str++;
+        bool exp_negative = parse_sign(&str);
+        int32_t exp = 0;
+        if ((*str < '0') || (*str > '9')) return MY_PARSE_SYNTAX;
+        for (; (*str >= '0') && (*str <= '9'); str++)
+        {
+            if (exp < MAX_EXPONENT) exp = exp * 10 + (*str - '0');
+        }
+        exponent += exp_negative ? -exp : exp;
+    }
+    if (*str != '\0') return MY_PARSE_SYNTAX;
+
+    float f = 0.0f;
+    if (mantissa != 0)
+    {
+        if (exponent > MAX_EXPONENT_F) return MY_PARSE_RANGE;
+        if (exponent < MIN_EXPONENT_F) return MY_PARSE_RANGE;
+        if ((mantissa <= ((uint64_t)1 << FLT_MANT_DIG)) && (exponent >= -10) && (exponent <= 10))
+        {
+            //Both operands exact: a single, correctly rounded operation
+            f = (float)(uint32_t)mantissa;
+            f = (exponent >= 0) ? (f * pow10_f[exponent]) : (f / pow10_f[-exponent]);
+        }
+        else
+        {
+            double d = (double)mantissa;
+            for (; exponent > POW10_D_MAX; exponent -= POW10_D_MAX) d *= pow10_d[POW10_D_MAX];
+            for (; exponent < -POW10_D_MAX; exponent += POW10_D_MAX) d /= pow10_d[POW10_D_MAX];
+            d = (exponent >= 0) ? (d * pow10_d[exponent]) : (d / pow10_d[-exponent]);
+            f = (float)d; //Rounds e.g. 3.4028235e38 down to FLT_MAX and 1.17549435e-38 up to FLT_MIN
+        }
+        if ((f > FLT_MAX) || (f < FLT_MIN)) return MY_PARSE_RANGE; //Overflow, or underflow into denormals/zero
+    }
+    *val = negative ? -f : f;
+    return MY_PARSE_OK;
+}
+/**
+ * @brief Decimal fraction to signed fixed point with frac_bits fractional bits, rounded to nearest (ties away
+ * from zero) however many digits are given. Integer math only.
+ * The fraction is converted exactly by doubling its digits frac_bits + 1 times; digits past frac_bits + 1
+ * can't move the result across a rounding boundary, so they are only checked for syntax.
+ */
+my_parse_err_t my_parse_q(const char* str, uint8_t frac_bits, int32_t* val)
+{
+    uint64_t integer = 0;
+    uint8_t fraction[MAX_Q_FRAC_DIGITS];
+    uint32_t fraction_digits = 0;
+    uint64_t fraction_bits = 0;
+    bool any_digits = false;
+
+    if (frac_bits > 31) return MY_PARSE_RANGE;
+    if (*str == '\0') return MY_PARSE_EMPTY;
+    bool negative = parse_sign(&str);
+    for (; (*str >= '0') && (*str <= '9'); str++)
+    {
+        any_digits = true;
+        integer = integer * 10u + (*str - '0');
+        if (integer > ((uint64_t)1 << 32)) integer = ((uint64_t)1 << 32); //Saturate, caught by the range check
+    }
+    if (*str == '.')
+    {
+        for (str++; (*str >= '0') && (*str <= '9'); str++)
+        {
+            any_digits = true;
+            if (fraction_digits <= frac_bits) fraction[fraction_digits++] = *str - '0';
+        }
+    }
+    if (!any_digits || (*str != '\0')) return MY_PARSE_SYNTAX;
+
+    //One more bit than kept, for the rounding: each pass moves the fraction's integer part (0 or 1) into it
+    for (uint32_t bit = 0; bit <= frac_bits; bit++)
+    {
+        uint32_t carry = 0;
+        for (uint32_t i = fraction_digits; i > 0; i--)
+        {
+            uint32_t d = fraction[i - 1] * 2u + carry;
+            carry = (d >= 10u);
+            fraction[i - 1] = carry ? (d - 10u) : d;
+        }
+        fraction_bits = (fraction_bits << 1) | carry;
+    }
+    uint64_t magnitude = (integer << frac_bits) + ((fraction_bits + 1u) >> 1);
+    if (magnitude > ((uint64_t)INT32_MAX + 1u)) return MY_PARSE_RANGE;
+    return apply_sign((uint32_t)magnitude, negative, val);
+}
+const char* my_parse_strerror(my_parse_err_t err)
+{
+    return (err < MY_PARSE_ERR_TOTAL) ? err_names[err] : "?";
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+//Strict: the whole string has to be a number, no leading/trailing whitespace
+typedef enum
+{
+    MY_PARSE_OK = 0,
+    MY_PARSE_EMPTY,
+    MY_PARSE_SYNTAX, //Stray character
+    MY_PARSE_RANGE, //Doesn't fit the destination type
+
+    MY_PARSE_ERR_TOTAL
+} my_parse_err_t;
+
+my_parse_err_t my_parse_u32(const char* str, uint32_t* val);
+my_parse_err_t my_parse_i32(const char* str, int32_t* val);
+my_parse_err_t my_parse_hex(const char* str, uint32_t* val);
+my_parse_err_t my_parse_float(const char* str, float* val);
+my_parse_err_t my_parse_q(const char* str, uint8_t frac_bits, int32_t* val);
+const char* my_parse_strerror(my_parse_err_t err);
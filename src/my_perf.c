@@ -0,0 +1,90 @@
+#include "my_perf.h"
+
+#include <xprintf.h>
+
+static my_perf_entry_t entries[MY_PERF_MAX_ENTRIES] = {
+    { .name = "loop" } //Busy part of the main loop pass, always present
+};
+static size_t entry_count = 1;
+static my_perf_stamp_t loop_stamp;
+
+/**
+ * PRIVATE API
+ */
+
+static void entry_add(my_perf_entry_t* entry, my_perf_stamp_t start, my_perf_stamp_t end)
+{
+    my_perf_stat_add(&(entry->cycles), end.cycles - start.cycles);
+    entry->instret += end.instret - start.instret;
+}
+
+/**
+ * PUBLIC API
+ */
+
+void my_perf_stat_reset(my_perf_stat_t* stat)
+{
+    *stat = (my_perf_stat_t){ 0 };
+}
+void my_perf_stat_print(const char* name, const my_perf_stat_t* stat)
+{
+    xprintf("%-12s\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32 "\t%" PRIu32,
+        name, stat->count, stat->min,
+        stat->count ? (uint32_t)(stat->sum / stat->count) : 0,
+        stat->max);
+}
+void my_perf_stat_print_hist(const my_perf_stat_t* stat)
+{
+    for (uint32_t i = 0; i < MY_PERF_HIST_BINS; i++)
+    {
+        if (stat->hist[i] == 0) continue;
+        xprintf("\t%s%" PRIu32 ": %" PRIu32 "\n",
+            i < (MY_PERF_HIST_BINS - 1) ? "<2^" : ">=2^",
+            i < (MY_PERF_HIST_BINS - 1) ? i : (i - 1),
+            stat->hist[i]);
+    }
+}
+
+my_perf_entry_t* my_perf_register(const char* name)
+{
+    if (entry_count >= MY_PERF_MAX_ENTRIES) return NULL;
+    my_perf_entry_t* entry = &(entries[entry_count++]);
+    entry->name = name;
+    return entry;
+}
+void my_perf_stop(my_perf_entry_t* entry, my_perf_stamp_t start)
+{
+    entry_add(entry, start, my_perf_start());
+}
+/**
+ * @brief Bracket the busy part of each main loop pass (idle sleep excluded)
+ */
+void my_perf_loop_begin(void)
+{
+    loop_stamp = my_perf_start();
+}
+void my_perf_loop_end(void)
+{
+    entry_add(&(entries[0]), loop_stamp, my_perf_start());
+}
+void my_perf_report(bool histograms)
+{
+    xprintf("Cycles @ %" PRIu32 " Hz\n"
+        "Name\t\tCount\tMin\tMean\tMax\tIPC%%\n", (uint32_t)OSC_SYSTEM_VALUE);
+    for (size_t i = 0; i < entry_count; i++)
+    {
+        const my_perf_entry_t* entry = &(entries[i]);
+        my_perf_stat_print(entry->name, &(entry->cycles));
+        xprintf("\t%" PRIu32 "\n",
+            entry->cycles.sum ? (uint32_t)((entry->instret * 100u) / entry->cycles.sum) : 0);
+        if (histograms) my_perf_stat_print_hist(&(entry->cycles));
+    }
+}
+void my_perf_reset(void)
+{
+    for (size_t i = 0; i < entry_count; i++)
+    {
+        my_perf_stat_reset(&(entries[i].cycles));
+        entries[i].instret = 0;
+    }
+}
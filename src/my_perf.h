@@ -0,0 +1,79 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mik32_hal.h>
+
+#define MY_PERF_HIST_BINS 24 //Bin i counts samples in [2^(i-1), 2^i) cycles, the last one is open-ended
+#define MY_PERF_MAX_ENTRIES 8
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[MY_PERF_HIST_BINS];
+} my_perf_stat_t;
+
+typedef struct my_perf_entry
+{
+    const char* name;
+    my_perf_stat_t cycles;
+    uint64_t instret;
+} my_perf_entry_t;
+
+typedef struct
+{
+    uint32_t cycles;
+    uint32_t instret;
+} my_perf_stamp_t;
+
+static inline uint32_t my_perf_get_cycles(void)
+{
+    return read_csr(mcycle);
+}
+static inline my_perf_stamp_t my_perf_start(void)
+{
+    my_perf_stamp_t stamp = { .instret = read_csr(minstret), .cycles = read_csr(mcycle) };
+    return stamp;
+}
+
+//Histogram bin: the bit length of cycles. Not __builtin_clz(), that is a libgcc call (flash) on RV32IMC.
+static inline uint32_t my_perf_get_bin(uint32_t cycles)
+{
+    uint32_t bin = 0;
+    for (uint32_t step = 16; step > 0; step /= 2)
+    {
+        if (cycles >= (1u << step))
+        {
+            bin += step;
+            cycles >>= step;
+        }
+    }
+    bin += cycles; //0 or 1 left
+    return bin < MY_PERF_HIST_BINS ? bin : (MY_PERF_HIST_BINS - 1);
+}
+//Inline so that the RAM_ATTR interrupt paths using it don't fetch from flash
+static inline __attribute__(( always_inline )) void my_perf_stat_add(my_perf_stat_t* stat, uint32_t cycles)
+{
+    if (stat->count == 0 || cycles < stat->min) stat->min = cycles;
+    if (cycles > stat->max) stat->max = cycles;
+    stat->sum += cycles;
+    stat->count++;
+    stat->hist[my_perf_get_bin(cycles)]++;
+}
+
+void my_perf_stat_reset(my_perf_stat_t* stat);
+void my_perf_stat_print(const char* name, const my_perf_stat_t* stat);
+void my_perf_stat_print_hist(const my_perf_stat_t* stat);
+
+my_perf_entry_t* my_perf_register(const char* name);
+void my_perf_stop(my_perf_entry_t* entry, my_perf_stamp_t start);
+void my_perf_loop_begin(void);
+void my_perf_loop_end(void);
+void my_perf_report(bool histograms);
+void my_perf_reset(void);
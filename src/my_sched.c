@@ -0,0 +1,207 @@
+#include "my_sched.h"
+
+#ifndef MY_SCHED_HOST
+#include "my_perf.h"
+#endif
+
+//Wraparound-safe "a is before b" for 32-bit microsecond timestamps
+#define TIME_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+static my_sched_task_t* heap[MY_SCHED_MAX_TASKS];
+static size_t heap_size = 0;
+
+/**
+ * PRIVATE API
+ */
+
+static void heap_place(size_t i, my_sched_task_t* task)
+{
+    heap[i] = task;
+    task->heap_index = (uint16_t)i;
+}
+static void sift_up(size_t i)
+{
+    my_sched_task_t* task = heap[i];
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (!TIME_BEFORE(task->deadline, heap[parent]->deadline)) break;
+        heap_place(i, heap[parent]);
+        i = parent;
+    }
+    heap_place(i, task);
+}
+static void sift_down(size_t i)
+{
+    my_sched_task_t* task = heap[i];
+    while (true)
+    {
+        size_t child = 2 * i + 1;
+        if (child >= heap_size) break;
+        if ((child + 1 < heap_size) && TIME_BEFORE(heap[child + 1]->deadline, heap[child]->deadline)) child++;
+        if (!TIME_BEFORE(heap[child]->deadline, task->deadline)) break;
+        heap_place(i, heap[child]);
+        i = child;
+    }
+    heap_place(i, task);
+}
+static bool insert(my_sched_task_t* task, uint32_t deadline)
+{
+    if ((task->heap_index != MY_SCHED_NOT_QUEUED) || (heap_size >= MY_SCHED_MAX_TASKS)) return false;
+    task->deadline = deadline;
+    heap[heap_size] = task;
+    sift_up(heap_size++);
+    return true;
+}
+static void update_stats(my_sched_task_t* task, uint32_t now)
+{
+    uint32_t lateness = now - task->deadline;
+    if (lateness > task->max_lateness) task->max_lateness = lateness;
+    if (task->runs > 0)
+    {
+        uint32_t period = now - task->last_start;
+        if (period < task->min_period) task->min_period = period;
+        if (period > task->max_period) task->max_period = period;
+    }
+    task->last_start = now;
+    task->runs++;
+}
+//Checked before a task's fields are touched, so that a rejected add leaves a queued task as it was
+static bool can_insert(const my_sched_task_t* task)
+{
+    return (task->heap_index == MY_SCHED_NOT_QUEUED) && (heap_size < MY_SCHED_MAX_TASKS);
+}
+static bool insert_new(my_sched_task_t* task, uint32_t deadline)
+{
+    task->min_period = UINT32_MAX;
+#ifndef MY_SCHED_HOST
+    if (!task->profile) task->profile = my_perf_register(task->name);
+#endif
+    return insert(task, deadline);
+}
+static void execute(my_sched_task_t* task)
+{
+#ifdef MY_SCHED_HOST
+    task->callback(task->ctx);
+#else
+    if (!task->profile)
+    {
+        task->callback(task->ctx);
+        return;
+    }
+    my_perf_stamp_t start = my_perf_start();
+    task->callback(task->ctx);
+    my_perf_stop(task->profile, start);
+#endif
+}
+
+/**
+ * PUBLIC API
+ */
+
+void my_sched_init(void)
+{
+    for (size_t i = 0; i < heap_size; i++) heap[i]->heap_index = MY_SCHED_NOT_QUEUED;
+    heap_size = 0;
+}
+
+/**
+ * @retval false if the task is already queued or the queue is full, the task is left unchanged
+ */
+bool my_sched_add_periodic(my_sched_task_t* task)
+{
+    if (!can_insert(task)) return false;
+    uint32_t now = get_micros_32();
+    task->periodic = true;
+    task->timer.last_time = now;
+    return insert_new(task, now + task->timer.interval);
+}
+bool my_sched_add_oneshot(my_sched_task_t* task, uint32_t delay)
+{
+    if (!can_insert(task)) return false;
+    uint32_t now = get_micros_32();
+    task->periodic = false;
+    task->timer.interval = delay;
+    task->timer.last_time = now;
+    return insert_new(task, now + delay);
+}
+bool my_sched_remove(my_sched_task_t* task)
+{
+    size_t i = task->heap_index;
+    if ((i >= heap_size) || (heap[i] != task)) return false;
+    task->heap_index = MY_SCHED_NOT_QUEUED;
+    if (i == --heap_size) return true;
+    //Fill the hole with the last task, which may need to go either way
+    my_sched_task_t* moved = heap[heap_size];
+    heap_place(i, moved);
+    sift_up(i);
+    if (heap[i] == moved) sift_down(i);
+    return true;
+}
+
+/**
+ * @brief Dispatch every task whose deadline has passed. Costs a single 32-bit timer read when nothing is due.
+ * @retval Number of callbacks executed
+ */
+uint32_t my_sched_run(void)
+{
+    uint32_t executed = 0;
+    //Every task runs at most once per call, so a zero-period task can't lock up the main loop
+    size_t budget = heap_size;
+
+    while (budget-- > 0 && heap_size > 0)
+    {
+        my_sched_task_t* task = heap[0];
+        uint32_t now = get_micros_32();
+        if (TIME_BEFORE(now, task->deadline)) break;
+
+        update_stats(task, now);
+        task->timer.last_time = task->deadline;
+        if (task->periodic)
+        {
+            //Keep the release grid unless a whole period was missed, then re-anchor to now
+            uint32_t next = task->deadline + task->timer.interval;
+            if (!TIME_BEFORE(now, next))
+            {
+                task->overruns++;
+                next = now + task->timer.interval;
+            }
+            task->deadline = next;
+            sift_down(0);
+        }
+        else
+        {
+            my_sched_remove(task);
+        }
+        execute(task);
+        executed++;
+    }
+    return executed;
+}
+
+bool my_sched_get_next_deadline(uint32_t* deadline)
+{
+    if (heap_size == 0) return false;
+    *deadline = heap[0]->deadline;
+    return true;
+}
+size_t my_sched_get_task_count(void)
+{
+    return heap_size;
+}
+const my_sched_task_t* my_sched_get_task(size_t index)
+{
+    return index < heap_size ? heap[index] : NULL;
+}
+void my_sched_reset_stats(void)
+{
+    for (size_t i = 0; i < heap_size; i++)
+    {
+        my_sched_task_t* task = heap[i];
+        task->runs = 0;
+        task->overruns = 0;
+        task->max_lateness = 0;
+        task->min_period = UINT32_MAX;
+        task->max_period = 0;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "my_types.h"
+
+#ifdef MY_SCHED_HOST
+uint32_t get_micros_32(void); //Host builds (tests, benchmarks) provide a fake clock instead of the SCR1 timer
+#else
+#include "my_hal.h"
+#endif
+
+#ifndef MY_SCHED_MAX_TASKS
+#define MY_SCHED_MAX_TASKS 16
+#endif
+#define MY_SCHED_NOT_QUEUED UINT16_MAX
+
+_Static_assert(MY_SCHED_MAX_TASKS < MY_SCHED_NOT_QUEUED, "MY_SCHED_MAX_TASKS: heap indices are 16 bits");
+
+#define MY_SCHED_TASK(task_name, cb, period) { .timer = { .interval = (period) }, .callback = (cb), \
+    .name = (task_name), .heap_index = MY_SCHED_NOT_QUEUED }
+
+typedef void (*my_sched_callback_t)(void* ctx);
+
+typedef struct
+{
+    soft_timer_32 timer; //interval = period (periodic) or delay (one-shot), last_time = last release
+    my_sched_callback_t callback;
+    void* ctx;
+    const char* name;
+    uint32_t deadline; //Next release, us
+    uint16_t heap_index;
+    bool periodic;
+    //Statistics
+    uint32_t runs;
+    uint32_t overruns; //Releases skipped because the task was late by a whole period or more
+    uint32_t max_lateness; //us
+    uint32_t min_period; //us, measured start-to-start
+    uint32_t max_period; //us
+    uint32_t last_start;
+    struct my_perf_entry* profile; //Execution time, not available in host builds
+} my_sched_task_t;
+
+void my_sched_init(void);
+bool my_sched_add_periodic(my_sched_task_t* task);
+bool my_sched_add_oneshot(my_sched_task_t* task, uint32_t delay);
+bool my_sched_remove(my_sched_task_t* task);
+uint32_t my_sched_run(void);
+bool my_sched_get_next_deadline(uint32_t* deadline);
+size_t my_sched_get_task_count(void);
+const my_sched_task_t* my_sched_get_task(size_t index);
+void my_sched_reset_stats(void);
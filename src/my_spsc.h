@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Single-producer single-consumer ring, e.g. ISR -> main loop. No locks, no critical sections.
+ * MY_SPSC_DEFINE(name, type, capacity) generates name_t and static inline name_*() functions for one element type
+ * and capacity (a power of two, all of it usable). Head and tail are free-running and masked on access.
+ * The producer only writes head, the consumer only writes tail; each publishes its index with a release store
+ * after touching the elements, and reads the other one with an acquire load (plain loads/stores plus fences,
+ * fine without the A extension as both are aligned words).
+ *
+ * Producer: name_push(), name_push_n(), name_free()
+ * Consumer: name_pop(), name_pop_n(), name_peek() + name_consume(), name_count()
+ * name_init() only while neither side is running.
+ */
+#define MY_SPSC_DEFINE(name, type, capacity) \
+    _Static_assert(((capacity) > 0) && (((capacity) & ((capacity) - 1)) == 0), #name ": capacity has to be a power of two"); \
+    typedef struct \
+    { \
+        uint32_t head; \
+        uint32_t tail; \
+        type buf[(capacity)]; \
+    } name##_t; \
+    \
+    static inline void name##_init(name##_t* q) \
+    { \
+        q->head = 0; \
+        q->tail = 0; \
+    } \
+    static inline uint32_t name##_count(const name##_t* q) \
+    { \
+        return __atomic_load_n(&(q->head), __ATOMIC_ACQUIRE) - q->tail; \
+    } \
+    static inline uint32_t name##_free(const name##_t* q) \
+    { \
+        return (capacity) - (q->head - __atomic_load_n(&(q->tail), __ATOMIC_ACQUIRE)); \
+    } \
+    static inline bool name##_push(name##_t* q, type value) \
+    { \
+        uint32_t head = q->head; \
+        if ((head - __atomic_load_n(&(q->tail), __ATOMIC_ACQUIRE)) >= (capacity)) return false; \
+        q->buf[head & ((capacity) - 1)] = value; \
+        __atomic_store_n(&(q->head), head + 1, __ATOMIC_RELEASE); \
+        return true; \
+    } \
+    static inline bool name##_pop(name##_t* q, type* value) \
+    { \
+        uint32_t tail = q->tail; \
+        if (__atomic_load_n(&(q->head), __ATOMIC_ACQUIRE) == tail) return false; \
+        *value = q->buf[tail & ((capacity) - 1)]; \
+        __atomic_store_n(&(q->tail), tail + 1, __ATOMIC_RELEASE); \
+        return true; \
+    } \
+    /* As many as fit, returns how many were pushed */ \
+    static inline size_t name##_push_n(name##_t* q, const type* src, size_t n) \
+    { \
+        uint32_t head = q->head; \
+        uint32_t space = (capacity) - (head - __atomic_load_n(&(q->tail), __ATOMIC_ACQUIRE)); \
+        if (n > space) n = space; \
+        uint32_t start = head & ((capacity) - 1); \
+        size_t first = ((capacity) - start < n) ? ((capacity) - start) : n; \
+        memcpy(&(q->buf[start]), src, first * sizeof(type)); \
+        memcpy(&(q->buf[0]), src + first, (n - first) * sizeof(type)); \
+        __atomic_store_n(&(q->head), head + n, __ATOMIC_RELEASE); \
+        return n; \
+    } \
+    /* As many as available, returns how many were popped */ \
+    static inline size_t name##_pop_n(name##_t* q, type* dst, size_t n) \
+    { \
+        uint32_t tail = q->tail; \
+        uint32_t available = __atomic_load_n(&(q->head), __ATOMIC_ACQUIRE) - tail; \
+        if (n > available) n = available; \
+        uint32_t start = tail & ((capacity) - 1); \
+        size_t first = ((capacity) - start < n) ? ((capacity) - start) : n; \
+        memcpy(dst, &(q->buf[start]), first * sizeof(type)); \
+        memcpy(dst + first, &(q->buf[0]), (n - first) * sizeof(type)); \
+        __atomic_store_n(&(q->tail), tail + n, __ATOMIC_RELEASE); \
+        return n; \
+    } \
+    /* Oldest elements up to the wrap point, in place; release them with name_consume() */ \
+    static inline size_t name##_peek(name##_t* q, type** span) \
+    { \
+        uint32_t tail = q->tail; \
+        uint32_t available = __atomic_load_n(&(q->head), __ATOMIC_ACQUIRE) - tail; \
+        uint32_t start = tail & ((capacity) - 1); \
+        *span = &(q->buf[start]); \
+        return ((capacity) - start < available) ? ((capacity) - start) : available; \
+    } \
+    static inline void name##_consume(name##_t* q, size_t n) \
+    { \
+        __atomic_store_n(&(q->tail), q->tail + n, __ATOMIC_RELEASE); \
+    }
@@ -0,0 +1,65 @@
+#include "my_stack.h"
+
+#include <xprintf.h>
+
+uintptr_t my_stack_isr_sp_min = UINTPTR_MAX;
+
+/**
+ * PUBLIC API
+ */
+
+/**
+ * @brief Fill the unused part of the stack with MY_STACK_PAINT, call first thing in main() with interrupts off.
+ * Plain loop on purpose, a memset() call would put its frame right where it is writing.
+ */
+void __attribute__(( noinline )) my_stack_paint(void)
+{
+    register uintptr_t sp asm ("sp");
+    volatile uint32_t* p = (volatile uint32_t*)((MY_STACK_BOTTOM + 3u) & ~(uintptr_t)3u);
+    volatile uint32_t* end = (volatile uint32_t*)((sp - MY_STACK_PAINT_MARGIN) & ~(uintptr_t)3u);
+    while (p < end) *p++ = MY_STACK_PAINT;
+}
+size_t my_stack_get_size(void)
+{
+    return MY_STACK_TOP - MY_STACK_BOTTOM;
+}
+/**
+ * @brief Deepest stack use since boot (main loop and interrupts together), bytes. Scans the painted area.
+ */
+size_t my_stack_get_high_water(void)
+{
+    const uint32_t* p = (const uint32_t*)((MY_STACK_BOTTOM + 3u) & ~(uintptr_t)3u);
+    const uint32_t* top = (const uint32_t*)MY_STACK_TOP;
+    while ((p < top) && (*p == MY_STACK_PAINT)) p++;
+    return MY_STACK_TOP - (uintptr_t)p;
+}
+/**
+ * @brief Cheap overflow check for the main loop: the lowest words are still painted
+ */
+bool my_stack_canary_ok(void)
+{
+    const uint32_t* p = (const uint32_t*)((MY_STACK_BOTTOM + 3u) & ~(uintptr_t)3u);
+    for (size_t i = 0; i < MY_STACK_CANARY_WORDS; i++)
+    {
+        if (p[i] != MY_STACK_PAINT) return false;
+    }
+    return true;
+}
+void my_stack_report(void)
+{
+    size_t size = my_stack_get_size();
+    size_t high_water = my_stack_get_high_water();
+    register uintptr_t sp asm ("sp");
+
+    xprintf("Stack: %" PRIu32 " bytes @ %08" PRIX32 "..%08" PRIX32 "\n"
+        "High water: %" PRIu32 " bytes (%" PRIu32 "%%), %" PRIu32 " never used\n"
+        "Now: %" PRIu32 " bytes (SP = %08" PRIX32 ")\n",
+        (uint32_t)size, (uint32_t)MY_STACK_BOTTOM, (uint32_t)MY_STACK_TOP,
+        (uint32_t)high_water, size ? (uint32_t)((high_water * 100u) / size) : 0, (uint32_t)(size - high_water),
+        (uint32_t)(MY_STACK_TOP - sp), (uint32_t)sp);
+    if (my_stack_isr_sp_min != UINTPTR_MAX)
+    {
+        xprintf("Deepest at trap entry: %" PRIu32 " bytes\n", (uint32_t)(MY_STACK_TOP - my_stack_isr_sp_min));
+    }
+    xprintf("Canary: %s\n", my_stack_canary_ok() ? "OK" : "DAMAGED");
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MY_STACK_PAINT 0xC5C5C5C5u //Pattern for never-used stack, unlikely as data or as an address
+#define MY_STACK_PAINT_MARGIN 64u //Bytes below the live sp left alone while painting (the painter's own calls)
+#define MY_STACK_CANARY_WORDS 4u //Lowest words of the stack checked from the main loop
+
+/*
+ * Stack bounds: the SDK's crt0 starts sp at __C_STACK_TOP__ and the stack grows down towards the heap.
+ * Override both for a different linker script.
+ */
+#ifndef MY_STACK_TOP
+extern char __C_STACK_TOP__[];
+#define MY_STACK_TOP ((uintptr_t)__C_STACK_TOP__)
+#endif
+#ifndef MY_STACK_BOTTOM
+extern char __heap_end[];
+#define MY_STACK_BOTTOM ((uintptr_t)__heap_end)
+#endif
+
+/*
+ * The trap handler runs on the same stack as the main loop. The painted high-water mark covers both,
+ * the lowest sp seen at trap entry tells how deep the main loop was when an interrupt came on top of it.
+ */
+extern uintptr_t my_stack_isr_sp_min;
+
+static inline __attribute__(( always_inline )) void my_stack_isr_enter(void)
+{
+    register uintptr_t sp asm ("sp");
+    if (sp < my_stack_isr_sp_min) my_stack_isr_sp_min = sp;
+}
+
+void my_stack_paint(void);
+size_t my_stack_get_size(void);
+size_t my_stack_get_high_water(void);
+bool my_stack_canary_ok(void);
+void my_stack_report(void);
@@ -0,0 +1,171 @@
+#include "my_telem.h"
+#include "my_mem.h"
+#include "nvs.h"
+
+#include <string.h>
+
+#define FRAME_HEADER_LEN 4u
+#define FRAME_MAX_LEN (FRAME_HEADER_LEN + MY_TELEM_MAX_PAYLOAD + sizeof(uint32_t))
+#define COBS_MAX_LEN (FRAME_MAX_LEN + FRAME_MAX_LEN / 254u + 1u)
+#define ENCODED_MAX_LEN (COBS_MAX_LEN + 2u) //Plus the delimiters
+
+static const uint8_t channel_types[MY_TELEM_CH_TOTAL] = {
+#define X(name, type) MY_TELEM_##type,
+    MY_TELEM_CHANNELS
+#undef X
+};
+
+MY_ARENA(arena, "telem", sizeof(my_telem_sample_t) * MY_TELEM_QUEUE_LEN + MY_MEM_ALIGN(FRAME_MAX_LEN) + MY_MEM_ALIGN(ENCODED_MAX_LEN));
+//Filled from any context (mostly the control tick), drained by my_telem_flush() in the main loop
+static my_telem_sample_t* queue;
+static volatile uint32_t queue_head = 0;
+static volatile uint32_t queue_tail = 0;
+static volatile bool enabled = false;
+static uint32_t dropped_since_frame = 0;
+static uint8_t seq = 0;
+static my_telem_stats_t stats = {};
+static uint8_t* frame;
+static uint8_t* encoded;
+
+/**
+ * PRIVATE API
+ */
+
+static size_t cobs_encode(const uint8_t* src, size_t len, uint8_t* dst)
+{
+    size_t code_pos = 0;
+    size_t out = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (src[i] != 0)
+        {
+            dst[out++] = src[i];
+            code++;
+        }
+        if ((src[i] == 0) || (code == 0xFF))
+        {
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+        }
+    }
+    dst[code_pos] = code;
+    return out;
+}
+//Payload is expected at frame + FRAME_HEADER_LEN
+static void send_frame(uint8_t type, size_t payload_len, uint32_t dropped)
+{
+    if (dropped > UINT16_MAX) dropped = UINT16_MAX;
+    frame[0] = type;
+    frame[1] = seq++;
+    frame[2] = (uint8_t)dropped;
+    frame[3] = (uint8_t)(dropped >> 8);
+    size_t len = FRAME_HEADER_LEN + payload_len;
+    uint32_t crc = xcrc32(frame, len);
+    memcpy(&(frame[len]), &crc, sizeof(crc));
+    len += sizeof(crc);
+
+    encoded[0] = 0;
+    len = cobs_encode(frame, len, &(encoded[1])) + 1;
+    encoded[len++] = 0;
+    uart_write(encoded, len);
+    stats.frames++;
+}
+
+/**
+ * PUBLIC API
+ */
+
+/**
+ * @brief Buffers come from the telemetry arena, call before anything else here
+ */
+HAL_StatusTypeDef my_telem_init(void)
+{
+    if (my_arena_init(&arena) != HAL_OK) return HAL_ERROR;
+    queue = my_arena_alloc(&arena, sizeof(my_telem_sample_t) * MY_TELEM_QUEUE_LEN);
+    frame = my_arena_alloc(&arena, FRAME_MAX_LEN);
+    encoded = my_arena_alloc(&arena, ENCODED_MAX_LEN);
+    return (queue && frame && encoded) ? HAL_OK : HAL_ERROR;
+}
+void my_telem_enable(bool enable)
+{
+    enabled = enable;
+}
+bool my_telem_is_enabled(void)
+{
+    return enabled;
+}
+/**
+ * @brief Queue a sample, safe to call from interrupt context
+ * @retval False when disabled or the queue is full (the sample is counted as dropped)
+ */
+bool RAM_ATTR my_telem_push(my_telem_channel_t channel, uint32_t raw)
+{
+    if (!enabled) return false;
+    uint32_t irq_state = my_irq_save();
+    uint32_t head = queue_head;
+    bool ok = (head - queue_tail) < MY_TELEM_QUEUE_LEN;
+    if (ok)
+    {
+        my_telem_sample_t* sample = &(queue[head & (MY_TELEM_QUEUE_LEN - 1)]);
+        sample->time_us = get_micros_32();
+        sample->channel = (uint8_t)channel;
+        sample->type = channel_types[channel];
+        sample->reserved = 0;
+        sample->value = raw;
+        queue_head = head + 1;
+        stats.samples++;
+    }
+    else
+    {
+        stats.dropped++;
+        dropped_since_frame++;
+    }
+    my_irq_restore(irq_state);
+    return ok;
+}
+/**
+ * @brief Send everything queued so far, in frames of up to MY_TELEM_MAX_BATCH samples
+ */
+void my_telem_flush(void)
+{
+    uint32_t available;
+    while ((available = queue_head - queue_tail) > 0)
+    {
+        size_t count = available > MY_TELEM_MAX_BATCH ? MY_TELEM_MAX_BATCH : available;
+        for (size_t i = 0; i < count; i++)
+        {
+            memcpy(&(frame[FRAME_HEADER_LEN + i * sizeof(my_telem_sample_t)]),
+                &(queue[(queue_tail + i) & (MY_TELEM_QUEUE_LEN - 1)]), sizeof(my_telem_sample_t));
+        }
+        queue_tail += count;
+        uint32_t irq_state = my_irq_save();
+        uint32_t dropped = dropped_since_frame;
+        dropped_since_frame = 0;
+        my_irq_restore(irq_state);
+        send_frame(MY_TELEM_FRAME_SAMPLES, count * sizeof(my_telem_sample_t), dropped);
+    }
+}
+/**
+ * @brief Send an arbitrary frame on the telemetry channel, regardless of sample streaming being enabled
+ * @param dropped Items the producer lost since its previous frame, reported to the host
+ */
+void my_telem_send(uint8_t type, const void* payload, size_t len, uint32_t dropped)
+{
+    if (len > MY_TELEM_MAX_PAYLOAD) len = MY_TELEM_MAX_PAYLOAD;
+    memcpy(&(frame[FRAME_HEADER_LEN]), payload, len);
+    send_frame(type, len, dropped);
+}
+void my_telem_get_stats(my_telem_stats_t* out)
+{
+    uint32_t irq_state = my_irq_save();
+    *out = stats;
+    my_irq_restore(irq_state);
+}
+void my_telem_reset_stats(void)
+{
+    uint32_t irq_state = my_irq_save();
+    stats = (my_telem_stats_t){ 0 };
+    my_irq_restore(irq_state);
+}
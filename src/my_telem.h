@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "my_hal.h"
+
+#define MY_TELEM_QUEUE_LEN 64 //Samples, has to be a power of two
+#define MY_TELEM_MAX_BATCH 16 //Samples per frame
+#define MY_TELEM_MAX_PAYLOAD (MY_TELEM_MAX_BATCH * sizeof(my_telem_sample_t))
+//Frame types
+#define MY_TELEM_FRAME_SAMPLES 0x01
+#define MY_TELEM_FRAME_LOG 0x02 //Deferred log records, see my_dlog.h
+#define MY_TELEM_FRAME_TRACE 0x03 //Trace buffer dump, see my_trace.h
+
+/*
+ * Channel list: X(name, type). tools/telem_decode.cpp parses this list to name the CSV columns,
+ * keep one entry per line and append new channels at the end to keep old captures decodable.
+ */
+#define MY_TELEM_CHANNELS \
+    X(CTRL_PERIOD, U32) \
+    X(CTRL_EXEC, U32)
+
+typedef enum
+{
+    MY_TELEM_U32 = 0,
+    MY_TELEM_I32,
+    MY_TELEM_F32
+} my_telem_type_t;
+
+typedef enum
+{
+#define X(name, type) MY_TELEM_CH_##name,
+    MY_TELEM_CHANNELS
+#undef X
+    MY_TELEM_CH_TOTAL
+} my_telem_channel_t;
+
+/*
+ * Frame (before COBS): type, seq, items dropped since the previous frame of that type (u16),
+ * then the payload, then xcrc32 of everything before it. Little-endian.
+ * On the wire every frame is surrounded by 0x00 delimiters, which plain CLI text never contains.
+ */
+typedef struct
+{
+    uint32_t time_us;
+    uint8_t channel;
+    uint8_t type;
+    uint16_t reserved;
+    uint32_t value; //Raw bits of the value, see type
+} my_telem_sample_t;
+
+typedef struct
+{
+    uint32_t samples;
+    uint32_t dropped;
+    uint32_t frames;
+} my_telem_stats_t;
+
+HAL_StatusTypeDef my_telem_init(void);
+void my_telem_enable(bool enable);
+bool my_telem_is_enabled(void);
+bool my_telem_push(my_telem_channel_t channel, uint32_t raw);
+void my_telem_flush(void);
+void my_telem_send(uint8_t type, const void* payload, size_t len, uint32_t dropped);
+void my_telem_get_stats(my_telem_stats_t* stats);
+void my_telem_reset_stats(void);
+
+static inline bool my_telem_push_u32(my_telem_channel_t channel, uint32_t value)
+{
+    return my_telem_push(channel, value);
+}
+static inline bool my_telem_push_i32(my_telem_channel_t channel, int32_t value)
+{
+    return my_telem_push(channel, (uint32_t)value);
+}
+static inline bool my_telem_push_f32(my_telem_channel_t channel, float value)
+{
+    union { float f; uint32_t u; } bits = { .f = value };
+    return my_telem_push(channel, bits.u);
+}
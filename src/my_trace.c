@@ -0,0 +1,52 @@
+#include "my_trace.h"
+
+#if MY_TRACE_ENABLE
+
+#include <string.h>
+
+#include "my_telem.h"
+
+#define FRAME_HEADER_LEN 8u
+#define RECORDS_PER_FRAME ((MY_TELEM_MAX_PAYLOAD - FRAME_HEADER_LEN) / sizeof(my_trace_record_t))
+
+_Static_assert(sizeof(my_trace_record_t) == 8, "trace records go out as they are in memory");
+
+my_trace_record_t my_trace_buffer[MY_TRACE_BUF_LEN];
+uint32_t my_trace_head = 0;
+volatile bool my_trace_paused = false;
+
+/**
+ * @brief Send the buffer as MY_TELEM_FRAME_TRACE frames, oldest event first, and restart tracing.
+ * Payload (little-endian): CPU clock in Hz (u32), index of the frame's first record in the dump (u16),
+ * records in the whole dump (u16), then 8-byte records (id, arg, mcycle). The first frame reports the
+ * records overwritten before the dump as dropped.
+ */
+void my_trace_dump(void)
+{
+    static uint8_t payload[FRAME_HEADER_LEN + RECORDS_PER_FRAME * sizeof(my_trace_record_t)];
+    const uint32_t hz = OSC_SYSTEM_VALUE;
+
+    my_trace_paused = true;
+    uint32_t head = my_trace_head;
+    uint16_t count = head < MY_TRACE_BUF_LEN ? head : MY_TRACE_BUF_LEN;
+    uint16_t index = 0;
+    memcpy(&(payload[0]), &hz, sizeof(hz));
+    memcpy(&(payload[6]), &count, sizeof(count));
+    do
+    {
+        uint16_t n = (count - index) < RECORDS_PER_FRAME ? (count - index) : RECORDS_PER_FRAME;
+        memcpy(&(payload[4]), &index, sizeof(index));
+        for (uint16_t i = 0; i < n; i++)
+        {
+            memcpy(&(payload[FRAME_HEADER_LEN + i * sizeof(my_trace_record_t)]),
+                &(my_trace_buffer[(head - count + index + i) & (MY_TRACE_BUF_LEN - 1)]), sizeof(my_trace_record_t));
+        }
+        my_telem_send(MY_TELEM_FRAME_TRACE, payload, FRAME_HEADER_LEN + n * sizeof(my_trace_record_t),
+            index == 0 ? head - count : 0);
+        index += n;
+    } while (index < count); //An empty buffer still sends one frame, so the host sees the dump
+    my_trace_head = 0;
+    my_trace_paused = false;
+}
+
+#endif
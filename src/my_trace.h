@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <mik32_hal.h>
+
+#include "my_irq.h"
+
+#ifndef MY_TRACE_ENABLE
+#define MY_TRACE_ENABLE 0 //Trace points compile to nothing unless enabled (i.e. -D MY_TRACE_ENABLE=1)
+#endif
+#define MY_TRACE_BUF_LEN 256 //Events, has to be a power of two
+
+/*
+ * Event list: X(name, context). tools/trace2json.py parses this list to name the events,
+ * keep one entry per line and append new events at the end to keep old captures decodable.
+ */
+#define MY_TRACE_EVENTS \
+    X(ISR, ISR) \
+    X(UART_RX, ISR) \
+    X(DMA_IRQ, ISR) \
+    X(EEPROM_IRQ, ISR) \
+    X(CLI, MAIN) \
+    X(NVS_WRITE, MAIN) \
+    X(NVS_ERASE, MAIN) \
+    X(SPI_XFER, MAIN)
+
+typedef enum
+{
+#define X(name, context) MY_TRACE_EV_##name,
+    MY_TRACE_EVENTS
+#undef X
+    MY_TRACE_EV_TOTAL
+} my_trace_event_t;
+
+#define MY_TRACE_FLAG_BEGIN 0x8000u
+#define MY_TRACE_FLAG_END 0x4000u
+#define MY_TRACE_ID_MASK 0x3FFFu
+
+typedef struct
+{
+    uint16_t id; //Event | flags
+    uint16_t arg;
+    uint32_t cycles; //mcycle
+} my_trace_record_t;
+
+#if MY_TRACE_ENABLE
+
+extern my_trace_record_t my_trace_buffer[MY_TRACE_BUF_LEN];
+extern uint32_t my_trace_head;
+extern volatile bool my_trace_paused;
+
+static inline void my_trace_record(uint16_t id, uint16_t arg)
+{
+    uint32_t cycles = read_csr(mcycle);
+    if (my_trace_paused) return;
+    //Shared by ISR and main context, the core has no atomics
+    uint32_t irq_state = my_irq_save();
+    my_trace_record_t* record = &(my_trace_buffer[my_trace_head++ & (MY_TRACE_BUF_LEN - 1)]);
+    record->id = id;
+    record->arg = arg;
+    record->cycles = cycles;
+    my_irq_restore(irq_state);
+}
+void my_trace_dump(void);
+
+#define TRACE(ev, arg) my_trace_record(MY_TRACE_EV_##ev, (arg))
+#define TRACE_BEGIN(ev) my_trace_record(MY_TRACE_EV_##ev | MY_TRACE_FLAG_BEGIN, 0)
+#define TRACE_END(ev) my_trace_record(MY_TRACE_EV_##ev | MY_TRACE_FLAG_END, 0)
+
+#else
+
+#define TRACE(ev, arg) do { } while (0)
+#define TRACE_BEGIN(ev) do { } while (0)
+#define TRACE_END(ev) do { } while (0)
+
+#endif
@@ -0,0 +1,160 @@
+#include "my_twheel.h"
+
+#define SLOTS (1u << MY_TWHEEL_LEVEL_BITS)
+#define SLOT_MASK (SLOTS - 1u)
+#define LEVEL_SHIFT(level) ((level) * MY_TWHEEL_LEVEL_BITS)
+#define MAX_DELTA ((1u << LEVEL_SHIFT(MY_TWHEEL_LEVELS)) - 1u)
+
+static my_twheel_timer_t* wheel[MY_TWHEEL_LEVELS][SLOTS];
+static uint32_t current_tick = 0; //Next tick to be processed
+static uint32_t last_tick_time = 0; //us
+static uint32_t pending = 0;
+
+/**
+ * PRIVATE API
+ */
+
+static void link(my_twheel_timer_t** head, my_twheel_timer_t* timer)
+{
+    timer->next = *head;
+    if (timer->next) timer->next->pprev = &(timer->next);
+    timer->pprev = head;
+    *head = timer;
+}
+static void unlink(my_twheel_timer_t* timer)
+{
+    *(timer->pprev) = timer->next;
+    if (timer->next) timer->next->pprev = timer->pprev;
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+static void enqueue(my_twheel_timer_t* timer)
+{
+    uint32_t delta = timer->expires - current_tick;
+    uint32_t at = timer->expires;
+
+    //Already due: run on the next processed tick
+    if ((int32_t)delta < 0)
+    {
+        delta = 0;
+        at = current_tick;
+    }
+    //Too far away: park in the last slot reachable, it will be re-cascaded
+    if (delta > MAX_DELTA)
+    {
+        delta = MAX_DELTA;
+        at = current_tick + MAX_DELTA;
+    }
+    size_t level = 0;
+    while ((level < (MY_TWHEEL_LEVELS - 1)) && (delta >= (1u << LEVEL_SHIFT(level + 1)))) level++;
+    link(&(wheel[level][(at >> LEVEL_SHIFT(level)) & SLOT_MASK]), timer);
+}
+//Move all timers of a higher-level slot down to where they belong now. Returns the slot index.
+static uint32_t cascade(size_t level)
+{
+    uint32_t index = (current_tick >> LEVEL_SHIFT(level)) & SLOT_MASK;
+    my_twheel_timer_t* list = wheel[level][index];
+    wheel[level][index] = NULL;
+    while (list)
+    {
+        my_twheel_timer_t* timer = list;
+        list = timer->next;
+        timer->next = NULL;
+        enqueue(timer);
+    }
+    return index;
+}
+static uint32_t process_tick(void)
+{
+    uint32_t executed = 0;
+    uint32_t index = current_tick & SLOT_MASK;
+
+    for (size_t level = 1; (level < MY_TWHEEL_LEVELS) && (index == 0); level++)
+    {
+        index = cascade(level);
+    }
+    index = current_tick & SLOT_MASK;
+    //Detach the slot first, so callbacks re-arming for "now" land in the next tick instead of this list
+    my_twheel_timer_t* list = wheel[0][index];
+    wheel[0][index] = NULL;
+    if (list) list->pprev = &list;
+    current_tick++;
+    while (list)
+    {
+        my_twheel_timer_t* timer = list;
+        unlink(timer);
+        pending--;
+        timer->callback(timer, timer->ctx);
+        executed++;
+    }
+    return executed;
+}
+
+/**
+ * PUBLIC API
+ */
+
+void my_twheel_init(void)
+{
+    for (size_t level = 0; level < MY_TWHEEL_LEVELS; level++)
+    {
+        for (size_t i = 0; i < SLOTS; i++) wheel[level][i] = NULL;
+    }
+    current_tick = 0;
+    pending = 0;
+    last_tick_time = get_micros_32();
+}
+
+void my_twheel_setup(my_twheel_timer_t* timer, my_twheel_callback_t callback, void* ctx)
+{
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->callback = callback;
+    timer->ctx = ctx;
+}
+/**
+ * @brief Arm (or re-arm) a timer, O(1). The callback never fires early, but may fire up to one tick late.
+ * Ticks that have elapsed but haven't been processed by my_twheel_tick() yet count as time already gone.
+ */
+void my_twheel_arm(my_twheel_timer_t* timer, uint32_t timeout_us)
+{
+    my_twheel_cancel(timer);
+    uint32_t elapsed = get_micros_32() - last_tick_time;
+    //Tick current_tick + n is processed once n + 1 ticks have passed since last_tick_time,
+    //so the timer goes to the first tick that ends at least timeout_us from now (split to not overflow)
+    uint32_t remainder = (elapsed % MY_TWHEEL_TICK_US) + (timeout_us % MY_TWHEEL_TICK_US);
+    timer->expires = current_tick + (elapsed / MY_TWHEEL_TICK_US) + (timeout_us / MY_TWHEEL_TICK_US) +
+        (remainder + (MY_TWHEEL_TICK_US - 1)) / MY_TWHEEL_TICK_US - 1;
+    enqueue(timer);
+    pending++;
+}
+bool my_twheel_cancel(my_twheel_timer_t* timer)
+{
+    if (!timer->pprev) return false;
+    unlink(timer);
+    pending--;
+    return true;
+}
+bool my_twheel_is_armed(const my_twheel_timer_t* timer)
+{
+    return timer->pprev != NULL;
+}
+/**
+ * @brief Single entry point: process every tick that elapsed since the last call and run expired callbacks.
+ * @retval Number of callbacks executed
+ */
+uint32_t my_twheel_tick(void)
+{
+    uint32_t executed = 0;
+    uint32_t now = get_micros_32();
+    while ((now - last_tick_time) >= MY_TWHEEL_TICK_US)
+    {
+        last_tick_time += MY_TWHEEL_TICK_US;
+        executed += process_tick();
+    }
+    return executed;
+}
+uint32_t my_twheel_get_pending(void)
+{
+    return pending;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef MY_TWHEEL_HOST
+uint32_t get_micros_32(void); //Host builds (benchmarks) provide a fake microsecond clock
+#else
+#include "my_hal.h"
+#endif
+
+#define MY_TWHEEL_TICK_US 1000
+#define MY_TWHEEL_LEVELS 4
+#define MY_TWHEEL_LEVEL_BITS 5 //32 slots per level, 2^20 ticks (~17 min) before a timeout gets re-cascaded
+
+typedef struct my_twheel_timer my_twheel_timer_t;
+typedef void (*my_twheel_callback_t)(my_twheel_timer_t* timer, void* ctx);
+
+struct my_twheel_timer
+{
+    my_twheel_timer_t* next;
+    my_twheel_timer_t** pprev; //NULL when the timer is not armed
+    uint32_t expires; //ticks
+    my_twheel_callback_t callback;
+    void* ctx;
+};
+
+void my_twheel_init(void);
+void my_twheel_setup(my_twheel_timer_t* timer, my_twheel_callback_t callback, void* ctx);
+void my_twheel_arm(my_twheel_timer_t* timer, uint32_t timeout_us);
+bool my_twheel_cancel(my_twheel_timer_t* timer);
+bool my_twheel_is_armed(const my_twheel_timer_t* timer);
+uint32_t my_twheel_tick(void);
+uint32_t my_twheel_get_pending(void);
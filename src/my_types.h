@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Types of my_hal.h that don't depend on the SDK, shared with the modules that host builds compile without it
+ * (MY_SCHED_HOST, MY_NVS_HOST). my_hal.h includes this, so the firmware and the host tests use one definition.
+ */
+
+#define MAIN_MOTOR_COUNT 2
+#define AUX_MOTOR_COUNT 4
+#define TOTAL_MOTOR_COUNT (MAIN_MOTOR_COUNT + AUX_MOTOR_COUNT)
+
+typedef enum
+{
+    MOTOR_CW = 0,
+    MOTOR_CCW
+} direction_t;
+
+struct _soft_timer
+{
+    uint32_t interval; //us
+    uint32_t last_time;
+} typedef soft_timer;
+struct _soft_timer_32
+{
+    uint32_t interval; //us
+    uint32_t last_time;
+} typedef soft_timer_32;
@@ -1,5 +1,7 @@
 #include "nvs.h"
 
+#include "my_trace.h"
+
 #include <xprintf.h>
 #include <mik32_hal_eeprom.h>
 #include <string.h>
@@ -9,11 +11,13 @@
 #define EEPROM_PAGE_WORDS 32
 #define EEPROM_PAGE_COUNT 64
 #define EEPROM_ERROR_STORAGE_PAGE (16) //Offset from EEPROM_PAGE_START
+#define EEPROM_MACRO_PAGE (24) //Offset from EEPROM_PAGE_START, MY_NVS_MACRO_COUNT pages from here
 #define EEPROM_OP_TIMEOUT 100000
 #define MY_EEPROM_ERR_VERSION_MISMATCH 0xFF
 #define GET_PAGE_ADDR(x) ((EEPROM_PAGE_START + (x)) * EEPROM_PAGE_WORDS * 4)
 #define GET_STORAGE_CRC(buf) xcrc32((uint8_t*)(buf), offsetof(nvs_storage_t, crc32))
 #define GET_ERROR_STORAGE_CRC(buf) xcrc32((uint8_t*)(buf), offsetof(nvs_error_storage_t, crc32))
+#define GET_MACRO_CRC(buf) xcrc32((uint8_t*)(buf), offsetof(nvs_macro_t, crc32))
 
 #define MY_STORAGE_VERSION 3 //Metadata occupies the first page
 
@@ -98,14 +102,37 @@ static nvs_storage_t storage = {
     .coproc_gpio_out_invert = 0
 };
 static uint32_t storage_version = 0;
+//What the storage pages hold, valid after a successful load or save. my_nvs_save() only rewrites pages that differ.
+static nvs_storage_t shadow;
+static bool shadow_valid = false;
+static my_nvs_save_stats_t save_stats = {};
 static HAL_EEPROM_HandleTypeDef heeprom = {
     .Instance = EEPROM_REGS,
     .Mode = HAL_EEPROM_MODE_THREE_STAGE,
     .ErrorCorrection = HAL_EEPROM_ECC_ENABLE,
     .EnableInterrupt = HAL_EEPROM_SERR_DISABLE
 };
+#define NVS_VALUE_U32(v) { .u = (v) }
+#define NVS_VALUE_F32(v) { .f = (v) }
+#define NVS_VALUE_BOOL(v) { .u = (v) }
+#define NVS_CTYPE_U32 uint32_t
+#define NVS_CTYPE_F32 float
+#define NVS_CTYPE_BOOL bool
+static const my_nvs_field_t fields[] = {
+#define X(member, type, count, min, max) \
+    { #member, offsetof(nvs_storage_t, member), MY_NVS_TYPE_##type, (count), NVS_VALUE_##type(min), NVS_VALUE_##type(max) },
+    MY_NVS_FIELDS(X)
+#undef X
+};
+#define X(member, type, count, min, max) \
+    static_assert(sizeof(((nvs_storage_t*)0)->member) == (sizeof(NVS_CTYPE_##type) * (count)), \
+        "MY_NVS_FIELDS entry doesn't match nvs_storage_t: " #member);
+MY_NVS_FIELDS(X)
+#undef X
 static const size_t storage_pages = sizeof(storage) / (sizeof(uint32_t) * EEPROM_PAGE_WORDS);
 static const size_t storage_remainder_words = ((sizeof(storage) + (sizeof(uint32_t) - 1)) / sizeof(uint32_t)) % EEPROM_PAGE_WORDS;
+static const size_t storage_data_pages = storage_pages + (storage_remainder_words > 0 ? 1u : 0u);
+static const size_t storage_crc_page = offsetof(nvs_storage_t, crc32) / (EEPROM_PAGE_WORDS * sizeof(uint32_t));
 
 /**
  * PRIVATE API
@@ -131,26 +158,50 @@ static HAL_StatusTypeDef read(uint32_t* dest)
     }
     return ret;
 }
-static HAL_StatusTypeDef write(const uint32_t* src)
+static size_t page_words(size_t page)
+{
+    return (page < storage_pages) ? EEPROM_PAGE_WORDS : storage_remainder_words;
+}
+//Storage page (0 = first data page) into an erased EEPROM page, the tail of the remainder page is zero-filled
+static HAL_StatusTypeDef write_page(size_t page, const uint32_t* src)
 {
-    HAL_StatusTypeDef ret = HAL_OK;
     uint32_t remainder_buffer[EEPROM_PAGE_WORDS] = { 0 };
 
-    for (size_t i = 0; i < storage_pages; i++)
+    src += page * EEPROM_PAGE_WORDS;
+    if (page >= storage_pages)
     {
-        ret = HAL_EEPROM_Write(&heeprom, GET_PAGE_ADDR(i + 1), (uint32_t*)(src + i * EEPROM_PAGE_WORDS), 
-            EEPROM_PAGE_WORDS, HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
+        for (size_t i = 0; i < storage_remainder_words; i++) remainder_buffer[i] = src[i];
+        src = remainder_buffer;
     }
-    if (ret != HAL_OK) return ret;
-    if (storage_remainder_words > 0)
+    return HAL_EEPROM_Write(&heeprom, GET_PAGE_ADDR(page + 1), (uint32_t*)src,
+        EEPROM_PAGE_WORDS, HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
+}
+static HAL_StatusTypeDef write(const uint32_t* src)
+{
+    HAL_StatusTypeDef ret = HAL_OK;
+
+    TRACE_BEGIN(NVS_WRITE);
+    for (size_t i = 0; (ret == HAL_OK) && (i < storage_data_pages); i++)
     {
-        for (size_t i = 0; i < storage_remainder_words; i++)
-        {
-            remainder_buffer[i] = (src + storage_pages * EEPROM_PAGE_WORDS)[i];
-        }
-        ret = HAL_EEPROM_Write(&heeprom, GET_PAGE_ADDR(storage_pages + 1), remainder_buffer, 
-            EEPROM_PAGE_WORDS, HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
+        ret = write_page(i, src);
     }
+    TRACE_END(NVS_WRITE);
+    return ret;
+}
+static bool page_dirty(size_t page)
+{
+    size_t offset = page * EEPROM_PAGE_WORDS;
+    return !shadow_valid ||
+        (memcmp((uint32_t*)(&storage) + offset, (uint32_t*)(&shadow) + offset, page_words(page) * sizeof(uint32_t)) != 0);
+}
+static HAL_StatusTypeDef save_page(size_t page)
+{
+    HAL_StatusTypeDef ret;
+
+    ret = HAL_EEPROM_Erase(&heeprom, GET_PAGE_ADDR(page + 1), EEPROM_PAGE_WORDS, HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
+    if (ret != HAL_OK) return ret;
+    ret = write_page(page, (uint32_t*)(&storage));
+    if (ret == HAL_OK) save_stats.pages_written++;
     return ret;
 }
 
@@ -289,7 +340,7 @@ static uint32_t xcrc32_step(uint32_t prev_crc, uint8_t next_byte)
 {
     return (prev_crc << 8u) ^ crc32_table[((prev_crc >> 24u) ^ next_byte) & 255u];
 }
-static uint32_t xcrc32(const uint8_t *buf, size_t len)
+uint32_t xcrc32(const uint8_t *buf, size_t len)
 {
     uint32_t crc = 0xFFFFFFFF;
     while (len--)
@@ -329,33 +380,61 @@ HAL_StatusTypeDef __noinline my_nvs_initialize(nvs_storage_t** return_ptr)
     return ret;
 }
 
+/**
+ * @brief Only the pages that differ from the EEPROM contents (per the shadow copy) are erased and programmed.
+ * The version page is written first and only when it doesn't hold MY_STORAGE_VERSION yet, the page with the CRC last:
+ * a save cut short leaves a CRC mismatch (defaults on the next boot), never a valid-looking mix of old and new data.
+ */
 HAL_StatusTypeDef my_nvs_save(void)
 {
     static const uint32_t version[EEPROM_PAGE_WORDS] = { MY_STORAGE_VERSION };
+    HAL_StatusTypeDef ret = HAL_OK;
+    uint32_t start = get_micros_32();
 
-    HAL_StatusTypeDef ret = my_nvs_reset(); //Erase required pages
-    if (ret != HAL_OK) return ret;
-    //Write version
-    ret = HAL_EEPROM_Write(&heeprom, GET_PAGE_ADDR(0), (uint32_t*)version, EEPROM_PAGE_WORDS,
-        HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
-    if (ret != HAL_OK) return ret;
-    //Write data
+    TRACE_BEGIN(NVS_WRITE);
+    save_stats.pages_written = 0;
+    save_stats.pages_total = storage_data_pages + 1u;
     storage.crc32 = GET_STORAGE_CRC(&storage);
-    return write((uint32_t*)(&storage));
+    if (storage_version != MY_STORAGE_VERSION)
+    {
+        shadow_valid = false; //Different layout or erased, nothing to compare against
+        ret = HAL_EEPROM_Erase(&heeprom, GET_PAGE_ADDR(0), EEPROM_PAGE_WORDS, HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
+        if (ret == HAL_OK) ret = HAL_EEPROM_Write(&heeprom, GET_PAGE_ADDR(0), (uint32_t*)version, EEPROM_PAGE_WORDS,
+            HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
+        if (ret == HAL_OK)
+        {
+            storage_version = MY_STORAGE_VERSION;
+            save_stats.pages_written++;
+        }
+    }
+    bool crc_page_dirty = page_dirty(storage_crc_page);
+    for (size_t i = 0; (ret == HAL_OK) && (i < storage_data_pages); i++)
+    {
+        if ((i != storage_crc_page) && page_dirty(i)) ret = save_page(i);
+    }
+    if ((ret == HAL_OK) && crc_page_dirty) ret = save_page(storage_crc_page);
+    //A failure leaves the pages in an unknown state, the next save rewrites all of them
+    shadow_valid = (ret == HAL_OK);
+    if (shadow_valid) shadow = storage;
+    TRACE_END(NVS_WRITE);
+    save_stats.time_us = get_time_past_32(start);
+    return ret;
 }
 HAL_StatusTypeDef my_nvs_reset(void)
 {
     HAL_StatusTypeDef ret;
+    TRACE_BEGIN(NVS_ERASE);
+    shadow_valid = false;
+    storage_version = 0;
     //Erase metadata
     ret = HAL_EEPROM_Erase(&heeprom, GET_PAGE_ADDR(0), EEPROM_PAGE_WORDS, HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
-    if (ret != HAL_OK) return ret;
     //Erase data
-    for (size_t i = 0; i < (storage_pages + 1u); i++)
+    for (size_t i = 0; (ret == HAL_OK) && (i < (storage_pages + 1u)); i++)
     {
         ret = HAL_EEPROM_Erase(&heeprom, GET_PAGE_ADDR(i + 1), EEPROM_PAGE_WORDS, HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
-        if (ret != HAL_OK) return ret;
     }
-    return HAL_OK;
+    TRACE_END(NVS_ERASE);
+    return ret;
 }
 HAL_StatusTypeDef my_nvs_load(void)
 {
@@ -377,64 +456,155 @@ HAL_StatusTypeDef my_nvs_load(void)
     else
     {
         storage = comparison_buffer; //This will copy
+        shadow = comparison_buffer;
     }
+    shadow_valid = (ret == HAL_OK);
 
     return ret;
 }
-HAL_StatusTypeDef __attribute__(( optimize("O0"), __noinline__ )) my_nvs_test(void)
+/**
+ * @brief One step of the NVS self-test, so that a caller can spread it over several ticks
+ * @param test Zero-initialized before the first step
+ * @return HAL_BUSY while there are steps left, otherwise the test result
+ */
+HAL_StatusTypeDef __attribute__(( optimize("O0"), __noinline__ )) my_nvs_test_step(my_nvs_test_t* test)
 {
-    nvs_storage_t comparison_buffer = {};
+    static nvs_storage_t comparison_buffer; //Must outlive the step
     HAL_StatusTypeDef ret = HAL_OK;
 
-    xprintf("Testing NVS:\nStorage size: whole pages = %" PRIu32 ", remainder words = %" PRIu32 "\n",
-        storage_pages, storage_remainder_words);
-
-    xputs("Calc CRC...\n");
-    storage.crc32 = GET_STORAGE_CRC(&storage);
-
-    xputs("Erase EEPROM...\n");
-    for (size_t i = 0; i < (storage_pages + 1); i++)
+    switch (test->step)
     {
-        ret = HAL_EEPROM_Erase(&heeprom, GET_PAGE_ADDR(i + 1), EEPROM_PAGE_WORDS, HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
-        if (ret != HAL_OK) return ret;
-    }
-
-    xputs("Write...\n");
-    ret = write((uint32_t*)(&storage));
-    if (ret != HAL_OK) return ret;
-
-    xputs("Read...\n");
-    ret = read((uint32_t*)(&comparison_buffer));
-    if (ret != HAL_OK) return ret;
-
-    xputs("Compare contents...\n"
-        "#\tW\tR\n");
-    for (uint32_t i = 0; i < sizeof(nvs_storage_t); i++)
+    case MY_NVS_TEST_BEGIN:
+        xprintf("Testing NVS:\nStorage size: whole pages = %" PRIu32 ", remainder words = %" PRIu32 "\n",
+            storage_pages, storage_remainder_words);
+        xputs("Calc CRC...\n");
+        storage.crc32 = GET_STORAGE_CRC(&storage);
+        shadow_valid = false; //The test overwrites the storage pages
+        xputs("Erase EEPROM...\n");
+        test->index = 0;
+        test->step = MY_NVS_TEST_ERASE;
+        break;
+    case MY_NVS_TEST_ERASE:
+        ret = HAL_EEPROM_Erase(&heeprom, GET_PAGE_ADDR(test->index + 1), EEPROM_PAGE_WORDS, HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
+        if (ret != HAL_OK) break;
+        if (++(test->index) >= (storage_pages + 1)) test->step = MY_NVS_TEST_WRITE;
+        break;
+    case MY_NVS_TEST_WRITE:
+        xputs("Write...\n");
+        ret = write((uint32_t*)(&storage));
+        test->step = MY_NVS_TEST_READ;
+        break;
+    case MY_NVS_TEST_READ:
+        xputs("Read...\n");
+        comparison_buffer = (nvs_storage_t){ };
+        ret = read((uint32_t*)(&comparison_buffer));
+        if (ret != HAL_OK) break;
+        xputs("Compare contents...\n"
+            "#\tW\tR\n");
+        test->index = 0;
+        test->step = MY_NVS_TEST_COMPARE;
+        break;
+    case MY_NVS_TEST_COMPARE:
     {
+        uint32_t i = test->index;
         uint8_t w = ((uint8_t*)(&storage))[i];
         uint8_t r = ((uint8_t*)(&comparison_buffer))[i];
         xprintf("%3" PRIu32 "\t%02" PRIX32 "\t%02" PRIX32, i, w, r);
         if (w != r) xputs("\t<---");
         xputc('\n');
+        if (++(test->index) >= sizeof(nvs_storage_t)) test->step = MY_NVS_TEST_CRC;
+        break;
     }
-    
-    xputs("Compare CRC...\n");
-    uint32_t crc_comp = GET_STORAGE_CRC(&comparison_buffer);
-    if (crc_comp != storage.crc32)
+    case MY_NVS_TEST_CRC:
     {
-        xprintf("CRC doesn't match: calc = 0x%08" PRIX32 ", stored = 0x%08" PRIX32 "\n",
-            crc_comp, storage.crc32);
-        ret = MY_NVS_ERR_CRC_FAILED;
+        xputs("Compare CRC...\n");
+        uint32_t crc_comp = GET_STORAGE_CRC(&comparison_buffer);
+        if (crc_comp != storage.crc32)
+        {
+            xprintf("CRC doesn't match: calc = 0x%08" PRIX32 ", stored = 0x%08" PRIX32 "\n",
+                crc_comp, storage.crc32);
+            ret = MY_NVS_ERR_CRC_FAILED;
+        }
+        xputs("Reset NVS.\n");
+        my_nvs_reset();
+        test->step = MY_NVS_TEST_DONE;
+        return ret;
     }
-
-    xputs("Reset NVS.\n");
-    my_nvs_reset();
+    default:
+        return HAL_OK;
+    }
+    if (ret != HAL_OK) test->step = MY_NVS_TEST_DONE;
+    return (ret == HAL_OK) ? HAL_BUSY : ret;
+}
+HAL_StatusTypeDef my_nvs_test(void)
+{
+    my_nvs_test_t test = { };
+    HAL_StatusTypeDef ret;
+    while ((ret = my_nvs_test_step(&test)) == HAL_BUSY);
     return ret;
 }
+
+/**
+ * FIELD ACCESS
+ */
+
+static uint8_t* get_field_ptr(const my_nvs_field_t* field, size_t index)
+{
+    size_t size = (field->type == MY_NVS_TYPE_BOOL) ? sizeof(bool) : sizeof(uint32_t);
+    return ((uint8_t*)(&storage)) + field->offset + (index * size);
+}
+const my_nvs_field_t* my_nvs_get_fields(size_t* count)
+{
+    *count = sizeof(fields) / sizeof(fields[0]);
+    return fields;
+}
+const my_nvs_field_t* my_nvs_find_field(const char* name)
+{
+    for (size_t i = 0; i < (sizeof(fields) / sizeof(fields[0])); i++)
+    {
+        if (strcmp(fields[i].name, name) == 0) return &(fields[i]);
+    }
+    return NULL;
+}
+HAL_StatusTypeDef my_nvs_field_get(const my_nvs_field_t* field, size_t index, my_nvs_value_t* value)
+{
+    if (index >= field->count) return HAL_ERROR;
+    const uint8_t* ptr = get_field_ptr(field, index);
+    if (field->type == MY_NVS_TYPE_BOOL) value->u = *((const bool*)ptr);
+    else memcpy(value, ptr, sizeof(*value));
+    return HAL_OK;
+}
+/**
+ * @brief Range-checked write to the RAM copy, takes effect in EEPROM on the next my_nvs_save()
+ */
+HAL_StatusTypeDef my_nvs_field_set(const my_nvs_field_t* field, size_t index, my_nvs_value_t value)
+{
+    if (index >= field->count) return HAL_ERROR;
+    if (field->type == MY_NVS_TYPE_F32)
+    {
+        if (!((value.f >= field->min.f) && (value.f <= field->max.f))) return HAL_ERROR; //NaN too
+    }
+    else
+    {
+        if ((value.u < field->min.u) || (value.u > field->max.u)) return HAL_ERROR;
+    }
+    uint8_t* ptr = get_field_ptr(field, index);
+    if (field->type == MY_NVS_TYPE_BOOL) *((bool*)ptr) = (value.u != 0);
+    else memcpy(ptr, &value, sizeof(value));
+    return HAL_OK;
+}
+
 uint32_t my_nvs_get_version(void)
 {
     return storage_version;
 }
+/**
+ * @brief Pages touched and time taken by the last my_nvs_save()
+ */
+void my_nvs_get_save_stats(my_nvs_save_stats_t* stats)
+{
+    *stats = save_stats;
+}
 void my_nvs_hexdump(void)
 {
     const uint8_t* ptr = (uint8_t*)(&storage);
@@ -444,23 +614,34 @@ void my_nvs_hexdump(void)
         xprintf("%02" PRIX32 "\n", (uint32_t)(ptr[i]));   
     }
 }
-HAL_StatusTypeDef my_nvs_get_whole_eeprom_crc32(uint32_t* crc)
+/**
+ * @brief Fold one more EEPROM page into the whole-EEPROM CRC
+ * @param state Zero-initialized before the first step, the result is in state->crc
+ * @return HAL_BUSY while there are pages left, HAL_OK once done
+ */
+HAL_StatusTypeDef my_nvs_eeprom_crc32_step(my_nvs_crc_t* state)
 {
     uint32_t buffer[EEPROM_PAGE_WORDS];
     HAL_StatusTypeDef ret;
 
-    *crc = 0xFFFFFFFF;
-    for (size_t i = 0; i < EEPROM_PAGE_COUNT; i++)
+    if (state->page == 0) state->crc = 0xFFFFFFFF;
+    if (state->page >= EEPROM_PAGE_COUNT) return HAL_OK;
+    if ((ret = HAL_EEPROM_Read(&heeprom, state->page * EEPROM_PAGE_WORDS * 4, buffer, EEPROM_PAGE_WORDS, EEPROM_OP_TIMEOUT))
+        != HAL_OK)
+        return ret;
+    for (size_t j = 0; j < (EEPROM_PAGE_WORDS * 4); j++)
     {
-        if ((ret = HAL_EEPROM_Read(&heeprom, i * EEPROM_PAGE_WORDS * 4, buffer, EEPROM_PAGE_WORDS, EEPROM_OP_TIMEOUT))
-            != HAL_OK)
-            return ret;
-        for (size_t j = 0; j < (EEPROM_PAGE_WORDS * 4); j++)
-        {
-            *crc = xcrc32_step(*crc, ((uint8_t*)buffer)[j]);
-        }
+        state->crc = xcrc32_step(state->crc, ((uint8_t*)buffer)[j]);
     }
-    return HAL_OK;
+    return (++(state->page) < EEPROM_PAGE_COUNT) ? HAL_BUSY : HAL_OK;
+}
+HAL_StatusTypeDef my_nvs_get_whole_eeprom_crc32(uint32_t* crc)
+{
+    my_nvs_crc_t state = { };
+    HAL_StatusTypeDef ret;
+    while ((ret = my_nvs_eeprom_crc32_step(&state)) == HAL_BUSY);
+    *crc = state.crc;
+    return ret;
 }
 
 /**
@@ -547,3 +728,50 @@ void my_nvs_print_errors(void)
             (uint32_t)(item->code), (uint32_t)(item->arg));
     }
 }
+
+/**
+ * MACROS
+ */
+
+static_assert(sizeof(nvs_macro_t) == (EEPROM_PAGE_WORDS * sizeof(uint32_t)));
+static_assert(EEPROM_MACRO_PAGE > EEPROM_ERROR_STORAGE_PAGE);
+static_assert((EEPROM_MACRO_PAGE + MY_NVS_MACRO_COUNT) <= (EEPROM_PAGE_COUNT - EEPROM_PAGE_START));
+
+/**
+ * @return HAL_ERROR for a free slot (blank page or bad CRC)
+ */
+HAL_StatusTypeDef my_nvs_macro_read(size_t slot, nvs_macro_t* macro)
+{
+    HAL_StatusTypeDef ret;
+
+    if (slot >= MY_NVS_MACRO_COUNT) return HAL_ERROR;
+    ret = HAL_EEPROM_Read(&heeprom, GET_PAGE_ADDR(EEPROM_MACRO_PAGE + slot), (uint32_t*)macro, EEPROM_PAGE_WORDS,
+        EEPROM_OP_TIMEOUT);
+    if (ret != HAL_OK) return ret;
+    if ((macro->crc32 != GET_MACRO_CRC(macro)) || (macro->name[0] == '\0')) return HAL_ERROR;
+    macro->name[MY_NVS_MACRO_NAME_LEN - 1] = '\0';
+    macro->body[MY_NVS_MACRO_BODY_LEN - 1] = '\0';
+    return HAL_OK;
+}
+HAL_StatusTypeDef my_nvs_macro_write(size_t slot, const char* name, const char* body)
+{
+    nvs_macro_t macro = { };
+    HAL_StatusTypeDef ret;
+
+    if ((slot >= MY_NVS_MACRO_COUNT) || (name[0] == '\0') ||
+        (strlen(name) >= MY_NVS_MACRO_NAME_LEN) || (strlen(body) >= MY_NVS_MACRO_BODY_LEN)) return HAL_ERROR;
+    strcpy(macro.name, name);
+    strcpy(macro.body, body);
+    macro.crc32 = GET_MACRO_CRC(&macro);
+    ret = HAL_EEPROM_Erase(&heeprom, GET_PAGE_ADDR(EEPROM_MACRO_PAGE + slot), EEPROM_PAGE_WORDS,
+        HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
+    if (ret != HAL_OK) return ret;
+    return HAL_EEPROM_Write(&heeprom, GET_PAGE_ADDR(EEPROM_MACRO_PAGE + slot), (uint32_t*)(&macro), EEPROM_PAGE_WORDS,
+        HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
+}
+HAL_StatusTypeDef my_nvs_macro_erase(size_t slot)
+{
+    if (slot >= MY_NVS_MACRO_COUNT) return HAL_ERROR;
+    return HAL_EEPROM_Erase(&heeprom, GET_PAGE_ADDR(EEPROM_MACRO_PAGE + slot), EEPROM_PAGE_WORDS,
+        HAL_EEPROM_WRITE_SINGLE, EEPROM_OP_TIMEOUT);
+}
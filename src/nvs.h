@@ -1,17 +1,34 @@
 #pragma once
 
 #include "my_pid.h"
-#include "my_hal.h"
 #include "my_err.h"
 
 #include <mik32_hal.h>
 
+#include "my_types.h"
+
+#ifdef MY_NVS_HOST
+//Host builds (tests) run on src/host/'s EEPROM and clock, the settings only need the motor definitions of my_types.h
+#include <inttypes.h>
+#include <stdbool.h>
+uint32_t get_micros_32(void);
+static inline uint32_t get_time_past_32(uint32_t from)
+{
+    return get_micros_32() - from;
+}
+#else
+#include "my_hal.h"
+#endif
+
 #include <stddef.h>
 #include <stdint.h>
 
 #define MY_NVS_ERR_TEST_FAILED 0xFE
 #define MY_NVS_ERR_CRC_FAILED 0xFD
 #define MY_NVS_ERROR_STORAGE_LEN 16u
+#define MY_NVS_MACRO_COUNT 8u //One EEPROM page each
+#define MY_NVS_MACRO_NAME_LEN 16u
+#define MY_NVS_MACRO_BODY_LEN 108u
 
 typedef enum
 {
@@ -67,6 +84,96 @@ typedef struct
     uint32_t crc32;
 } __attribute__(( __aligned__(4) )) nvs_storage_t;
 
+/**
+ * Field descriptors of nvs_storage_t for the generic get/set console commands: X(member, type, count, min, max).
+ * Keep in sync with the struct above, nvs.c checks member sizes at compile time. crc32 is deliberately left out.
+ */
+#define MY_NVS_FIELDS(X) \
+    X(casement_config, U32, 1, CONFIG_SINGLE_CASEMENT_SINGLE_MOTOR, CONFIG_DUAL_CASEMENT) \
+    X(motion_timeout, U32, 1, 0, 600000000) \
+    X(homing_timeout, U32, 1, 0, 600000000) \
+    X(homing_speed_0, F32, 1, 0.0f, 2.0f) \
+    X(homing_speed_1, F32, 1, 0.0f, 2.0f) \
+    X(jog_target_speed_0, F32, 1, 0.0f, 2.0f) \
+    X(jog_target_speed_1, F32, 1, 0.0f, 2.0f) \
+    X(acceleration_target_0, F32, 1, 0.0f, 10.0f) \
+    X(acceleration_target_1, F32, 1, 0.0f, 10.0f) \
+    X(encoder_counts_to_meters_0, F32, 1, 0.0f, 1.0f) \
+    X(encoder_counts_to_meters_1, F32, 1, 0.0f, 1.0f) \
+    X(tunings_0.kI, F32, 1, 0.0f, 1000.0f) \
+    X(tunings_0.kP, F32, 1, 0.0f, 1000.0f) \
+    X(tunings_0.min_power, F32, 1, 0.0f, 1.0f) \
+    X(tunings_0.brake_scaling, F32, 1, 0.0f, 100.0f) \
+    X(tunings_1.kI, F32, 1, 0.0f, 1000.0f) \
+    X(tunings_1.kP, F32, 1, 0.0f, 1000.0f) \
+    X(tunings_1.min_power, F32, 1, 0.0f, 1.0f) \
+    X(tunings_1.brake_scaling, F32, 1, 0.0f, 100.0f) \
+    X(main_motor_dir, U32, MAIN_MOTOR_COUNT, MOTOR_CW, MOTOR_CCW) \
+    X(encoder_dir, U32, MAIN_MOTOR_COUNT, MOTOR_CW, MOTOR_CCW) \
+    X(main_current_limit, F32, MAIN_MOTOR_COUNT, 0.0f, 10.0f) \
+    X(main_power_limit, F32, MAIN_MOTOR_COUNT, 0.0f, 1.0f) \
+    X(target_open_distance_0, F32, 1, 0.0f, 100.0f) \
+    X(target_closed_distance_0, F32, 1, 0.0f, 100.0f) \
+    X(target_partial_open_distance_0, F32, 1, 0.0f, 100.0f) \
+    X(target_open_distance_1, F32, 1, 0.0f, 100.0f) \
+    X(target_closed_distance_1, F32, 1, 0.0f, 100.0f) \
+    X(target_partial_open_distance_1, F32, 1, 0.0f, 100.0f) \
+    X(hard_brake_time, F32, 1, 0.0f, 60.0f) \
+    X(position_precision, F32, 1, 0.0f, 1.0f) \
+    X(velocity_precision, F32, 1, 0.0f, 1.0f) \
+    X(aux_motor_power, F32, AUX_MOTOR_COUNT, 0.0f, 1.0f) \
+    X(aux_motor_dir, U32, AUX_MOTOR_COUNT, MOTOR_CW, MOTOR_CCW) \
+    X(aux_current_limit, F32, AUX_MOTOR_COUNT, 0.0f, 10.0f) \
+    X(seal_enabled, BOOL, 1, false, true) \
+    X(vent_target_pressure, F32, 1, 0.0f, 5.0f) \
+    X(pump_max_pressure, F32, 1, 0.0f, 5.0f) \
+    X(pump_min_pressure, F32, 1, 0.0f, 5.0f) \
+    X(steps_enabled, BOOL, 1, false, true) \
+    X(steps_dual, BOOL, 1, false, true) \
+    X(coproc_gpio_out_invert, U32, 1, 0, 0x3F)
+
+typedef enum
+{
+    MY_NVS_TYPE_U32 = 0, //Also enums
+    MY_NVS_TYPE_F32,
+    MY_NVS_TYPE_BOOL
+} my_nvs_type_t;
+typedef union
+{
+    uint32_t u; //U32 and BOOL
+    float f;
+} my_nvs_value_t;
+typedef struct
+{
+    const char* name;
+    uint16_t offset;
+    uint8_t type; //my_nvs_type_t
+    uint8_t count; //Array length, 1 for scalars
+    my_nvs_value_t min;
+    my_nvs_value_t max;
+} my_nvs_field_t;
+
+typedef enum
+{
+    MY_NVS_TEST_BEGIN = 0,
+    MY_NVS_TEST_ERASE,
+    MY_NVS_TEST_WRITE,
+    MY_NVS_TEST_READ,
+    MY_NVS_TEST_COMPARE,
+    MY_NVS_TEST_CRC,
+    MY_NVS_TEST_DONE
+} my_nvs_test_step_t;
+typedef struct
+{
+    my_nvs_test_step_t step;
+    uint32_t index; //Page or byte, depending on the step
+} my_nvs_test_t;
+typedef struct
+{
+    uint32_t page;
+    uint32_t crc;
+} my_nvs_crc_t;
+
 typedef struct
 {
     uint16_t code;
@@ -81,15 +188,41 @@ typedef struct
     uint32_t crc32;
 } __attribute__(( __aligned__(4) )) nvs_error_storage_t;
 
+typedef struct
+{
+    char name[MY_NVS_MACRO_NAME_LEN]; //NUL-terminated, empty = free slot
+    char body[MY_NVS_MACRO_BODY_LEN]; //';'-separated commands, NUL-terminated
+    uint32_t crc32;
+} __attribute__(( __aligned__(4) )) nvs_macro_t;
+
+typedef struct
+{
+    uint32_t pages_written; //Erased and programmed, the version page included
+    uint32_t pages_total; //What a full save writes
+    uint32_t time_us;
+} my_nvs_save_stats_t;
+
 HAL_StatusTypeDef my_nvs_initialize(nvs_storage_t** return_ptr);
 HAL_StatusTypeDef my_nvs_save(void);
 HAL_StatusTypeDef my_nvs_reset(void);
 HAL_StatusTypeDef my_nvs_load(void);
 HAL_StatusTypeDef my_nvs_test(void);
+HAL_StatusTypeDef my_nvs_test_step(my_nvs_test_t* test);
 uint32_t my_nvs_get_version(void);
+void my_nvs_get_save_stats(my_nvs_save_stats_t* stats);
 void my_nvs_hexdump(void);
 HAL_StatusTypeDef my_nvs_get_whole_eeprom_crc32(uint32_t* crc);
+HAL_StatusTypeDef my_nvs_eeprom_crc32_step(my_nvs_crc_t* state);
+const my_nvs_field_t* my_nvs_get_fields(size_t* count);
+const my_nvs_field_t* my_nvs_find_field(const char* name);
+HAL_StatusTypeDef my_nvs_field_get(const my_nvs_field_t* field, size_t index, my_nvs_value_t* value);
+HAL_StatusTypeDef my_nvs_field_set(const my_nvs_field_t* field, size_t index, my_nvs_value_t value);
+uint32_t xcrc32(const uint8_t* buf, size_t len);
 
 const nvs_error_storage_t* my_nvs_err_storage_init(void);
 void my_nvs_save_error(my_err_t err, uint16_t arg);
-void my_nvs_print_errors(void);
\ No newline at end of file
+void my_nvs_print_errors(void);
+
+HAL_StatusTypeDef my_nvs_macro_read(size_t slot, nvs_macro_t* macro);
+HAL_StatusTypeDef my_nvs_macro_write(size_t slot, const char* name, const char* body);
+HAL_StatusTypeDef my_nvs_macro_erase(size_t slot);
\ No newline at end of file
@@ -15,6 +15,7 @@
 #include <unistd.h>
 #include <mik32_hal.h>
 #include "sys_command_line.h"
+#include "my_mem.h"
 
 #define EXIT_SUCCESS HAL_OK
 #define EXIT_FAILURE HAL_ERROR
@@ -32,36 +33,89 @@
 typedef struct {
     uint8_t buff[MAX_LINE_LEN];
     uint8_t len;
+    uint8_t cursor;
 } HANDLE_TYPE_S;
 
 /*
- * Command entry
+ * Decoded keys
  */
+typedef enum {
+    CLI_KEY_NONE = 0,
+    CLI_KEY_CHAR,
+    CLI_KEY_ENTER,
+    CLI_KEY_BACKSPACE,
+    CLI_KEY_DELETE,
+    CLI_KEY_UP,
+    CLI_KEY_DOWN,
+    CLI_KEY_LEFT,
+    CLI_KEY_RIGHT,
+    CLI_KEY_HOME,
+    CLI_KEY_END,
+    CLI_KEY_KILL_END,
+    CLI_KEY_KILL_LINE,
+    CLI_KEY_CANCEL,
+    CLI_KEY_SEARCH,
+} CLI_KEY_E;
+
+/*
+ * Escape sequence decoder, fed one byte at a time
+ */
+typedef enum {
+    ESC_STATE_NONE = 0,
+    ESC_STATE_ESC,      /* got ESC */
+    ESC_STATE_CSI,      /* got ESC [ */
+    ESC_STATE_SS3,      /* got ESC O */
+} ESC_STATE_E;
+
 typedef struct {
-    const char *pCmd;
-    const char *pHelp;
-    uint8_t (*pFun)(int argc, char *argv[]);
-} COMMAND_S;
+    ESC_STATE_E state;
+    uint8_t param;
+    bool last_cr;
+} ESC_DECODER_S;
 
 /*
  * Command line history
  */
 typedef struct {
-    char cmd[HISTORY_MAX][MAX_LINE_LEN];
-    uint8_t count;
-    uint8_t latest;
-    uint8_t show;
+    uint8_t buf[HISTORY_BUF_SIZE];  /* ring of entries: length byte, then the text without NUL, oldest first */
+    uint16_t tail;                  /* oldest entry */
+    uint16_t used;                  /* bytes */
+    uint16_t count;
+    uint16_t show;                  /* entry being shown, 1 = latest, 0 = none */
 }HISTORY_S;
 
+/*
+ * Command that yielded and is resumed on every cli_run(), argv points into the line buffer
+ * which is left alone until it finishes
+ */
+typedef struct {
+	const COMMAND_S	*entry;
+	uint8_t			argc;
+	char			*argv[MAX_ARGC];
+	uint32_t		start;			/* cli_micros() when it was started */
+} ACTIVE_CMD_S;
+
 /*******************************************************************************
  *
  * 	Internal variables
  *
  ******************************************************************************/
 
-shell_queue_s 			cli_rx_buff; 				/* 64 bytes FIFO, saving commands from the terminal */
-COMMAND_S				CLI_commands[MAX_COMMAND_NB];
-static HISTORY_S 		history;
+MY_SPSC_DEFINE(cli_rx_fifo, uint8_t, CLI_RX_BUFF_LEN)
+static cli_rx_fifo_t	cli_rx_buff;				/* UART (ISR or task) -> shell, single producer/consumer */
+COMMAND_S				CLI_commands[MAX_COMMAND_NB];	/* runtime overlay, see cli_add_command() */
+static size_t			CLI_commands_count = 0;
+MY_ARENA(cli_arena, "cli", MY_MEM_ALIGN(sizeof(HISTORY_S)) + MY_MEM_ALIGN(CLI_SCRIPT_LEN + 1) +
+		MY_MEM_ALIGN(CLI_RECORD_LEN + CLI_RECORD_TAIL_LEN));	/* the buffers below, allocated by cli_init() */
+static HISTORY_S 		*history;					/* NULL until cli_init() got the buffers, cli_run() does nothing meanwhile */
+static ACTIVE_CMD_S		cli_active;
+static char				*cli_script;				/* line being run, CLI_SCRIPT_LEN + 1 for the end marker past the last NUL */
+static char				*cli_script_next;			/* commands not started yet */
+static char				*cli_record;				/* machine mode record line being built, starts with '@' */
+static size_t			cli_record_len				= 1;
+static bool				cli_record_truncated		= false;	/* a pair didn't fit and was dropped */
+bool					cli_machine_mode			= false;
+CLI_PT_S				cli_pt;
 char *cli_logs_names[] = {"SHELL",
 #ifdef CLI_ADDITIONAL_LOG_CATEGORIES
 #define X(name, b) #name,
@@ -85,6 +139,8 @@ const char				cli_log_help[]				= "Controls which logs are displayed."
 													  "\n\t\"log show\" to show which logs are enabled"
 													  "\n\t\"log on/off all\" to enable/disable all logs"
 													  "\n\t\"log on/off [CAT1 CAT2 CAT...]\" to enable/disable the logs for categories [CAT1 CAT2 CAT...]";
+const char				cli_mode_help[]				= "\"mode machine\": no echo/prompt/colours, one \"@ key=value rc= us=\" record per command"
+													  "\n\t\"mode human\": back to the interactive terminal";
 bool 					cli_password_ok 			= false;
 
 /*******************************************************************************
@@ -95,16 +151,30 @@ bool 					cli_password_ok 			= false;
 
 static void 	cli_history_add			(char* buff);
 static uint8_t 	cli_history_show		(uint8_t mode, char** p_history);
-static void 	cli_rx_handle			(shell_queue_s *rx_buff);
+static uint8_t 	cli_history_search		(const char* prefix, uint8_t len, char** p_history);
+static void 	cli_rx_handle			(cli_rx_fifo_t *rx_buff);
+static void 	cli_resume				(void);
+static void 	cli_script_run			(void);
+static void 	cli_record_close		(int result, uint32_t us);
 uint8_t 		cli_help				(int argc, char *argv[]);
 uint8_t 		cli_clear				(int argc, char *argv[]);
 uint8_t 		cli_reset				(int argc, char *argv[]);
 uint8_t 		cli_log					(int argc, char *argv[]);
+uint8_t 		cli_mode				(int argc, char *argv[]);
 void 			cli_add_command			(const char *command, const char *help, uint8_t (*exec)(int argc, char *argv[]));
 void 			greet					(void);
 void 			cli_disable_log_entry	(char *str);
 void 			cli_enable_log_entry	(char *str);
 
+/* Shell builtins, sorted like cli_static_commands */
+static const COMMAND_S	cli_builtin_commands[] = {
+	CLI_COMMAND("cls", cli_clear_help, cli_clear),
+	CLI_COMMAND("help", cli_help_help, cli_help),
+	CLI_COMMAND("log", cli_log_help, cli_log),
+	CLI_COMMAND("mode", cli_mode_help, cli_mode),
+};
+#define CLI_BUILTIN_COMMANDS_COUNT	(sizeof(cli_builtin_commands) / sizeof(cli_builtin_commands[0]))
+
 __attribute__((weak)) int _isatty(int file){
 	switch(file){
 	case STDERR_FILENO:
@@ -124,42 +194,77 @@ __attribute__((weak)) int _isatty(int file){
  ******************************************************************************/
 
 /**
-  * @brief          add a command to the history
+  * @brief          byte at a (wrapping) history ring position
+  */
+static inline uint8_t *cli_history_at(uint16_t pos)
+{
+    return &history->buf[pos % HISTORY_BUF_SIZE];
+}
+
+/**
+  * @brief          ring position of an entry
+  * @param  n:      1 for the latest, history->count for the oldest
+  * @retval         position of its length byte
+  */
+static uint16_t cli_history_entry(uint16_t n)
+{
+    uint16_t pos = history->tail;
+
+    /* length-prefixed, so walk from the oldest one */
+    for (uint16_t i = history->count - n; i > 0; i--) {
+        pos = (pos + 1 + *cli_history_at(pos)) % HISTORY_BUF_SIZE;
+    }
+    return pos;
+}
+
+/**
+  * @brief          copy an entry out of the ring, NUL-terminated
+  * @retval         pointer to the copy (static, valid until the next call)
+  */
+static char *cli_history_copy(uint16_t pos)
+{
+    static char line[MAX_LINE_LEN];
+    uint8_t len = *cli_history_at(pos);
+
+    for (uint8_t i = 0; i < len; i++) {
+        line[i] = *cli_history_at(pos + 1 + i);
+    }
+    line[len] = '\0';
+    return line;
+}
+
+/**
+  * @brief          add a command to the history, evicting the oldest ones to make room
   * @param  buff:   command
   * @retval         null
   */
 static void cli_history_add(char* buff)
 {
     uint16_t len;
-    uint8_t index = history.latest;
 
     if (NULL == buff) return;
 
     len = strlen((const char *)buff);
-    if (len >= MAX_LINE_LEN) return;  /* command too long */
+    if ((len == 0) || (len >= MAX_LINE_LEN) || (len + 1 > HISTORY_BUF_SIZE)) return;  /* command too long */
 
-    /* find the latest one */
-    if (0 != index) {
-        index--;
-    } else {
-        index = HISTORY_MAX - 1;
-    }
+    /* skip it if it is the same as the latest one */
+    history->show = 0;
+    if ((history->count > 0) && (0 == strcmp(cli_history_copy(cli_history_entry(1)), buff))) return;
 
-    if (0 != memcmp(history.cmd[index], buff, len)) {
-        /* if the new one is different with the latest one, the save */
-        memset((void *)history.cmd[history.latest], 0x00, MAX_LINE_LEN);
-        memcpy((void *)history.cmd[history.latest], (const void *)buff, len);
-        if (history.count < HISTORY_MAX) {
-            history.count++;
-        }
-
-        history.latest++;
-        if (history.latest >= HISTORY_MAX) {
-            history.latest = 0;
-        }
+    while (HISTORY_BUF_SIZE - history->used < len + 1) {
+        uint16_t evicted = 1 + *cli_history_at(history->tail);
+        history->tail = (history->tail + evicted) % HISTORY_BUF_SIZE;
+        history->used -= evicted;
+        history->count--;
     }
 
-    history.show = 0;
+    uint16_t head = history->tail + history->used;
+    *cli_history_at(head) = len;
+    for (uint16_t i = 0; i < len; i++) {
+        *cli_history_at(head + 1 + i) = buff[i];
+    }
+    history->used += len + 1;
+    history->count++;
 }
 
 
@@ -171,49 +276,75 @@ static void cli_history_add(char* buff)
   */
 static uint8_t cli_history_show(uint8_t mode, char** p_history)
 {
-    uint8_t err = true;
-    uint8_t num;
-    uint8_t index;
-
-    if (0 == history.count) return err;
+    if (0 == history->count) return true;
 
     if (true == mode) {
         /* look up */
-        if (history.show < history.count) {
-            history.show++;
+        if (history->show < history->count) {
+            history->show++;
         }
     } else {
         /* look down */
-        if (1 < history.show) {
-            history.show--;
+        if (1 < history->show) {
+            history->show--;
         }
     }
-
-    num = history.show;
-    index = history.latest;
-    while (num) {
-        if (0 != index) {
-            index--;
-        } else {
-            index = HISTORY_MAX - 1;
-        }
-        num--;
+    if (0 == history->show) {
+        history->show = 1;
     }
 
-    err = false;
-    *p_history = history.cmd[index];
-
-    return err;
+    *p_history = cli_history_copy(cli_history_entry(history->show));
+    return false;
 }
 
-void cli_init()
+/**
+  * @brief              find the next older command starting with a prefix, continuing from the one shown
+  * @param  prefix:     not NUL-terminated
+  * @param  p_history:  target history command
+  * @retval             TRUE for no match, FALSE for success
+  */
+static uint8_t cli_history_search(const char* prefix, uint8_t len, char** p_history)
 {
-	shell_queue_init(&cli_rx_buff);
-    memset((uint8_t *)&history, 0, sizeof(history));
+    for (uint16_t n = history->show + 1; n <= history->count; n++) {
+        uint16_t pos = cli_history_entry(n);
+        if (*cli_history_at(pos) < len) continue;
+
+        uint8_t i = 0;
+        while ((i < len) && (*cli_history_at(pos + 1 + i) == (uint8_t)prefix[i])) i++;
+        if (i == len) {
+            history->show = n;
+            *p_history = cli_history_copy(pos);
+            return false;
+        }
+    }
+    return true;
+}
 
-    for(size_t j = 0; j < MAX_COMMAND_NB; j++){
-    	CLI_commands[j].pCmd = "";
-    	CLI_commands[j].pFun = NULL;
+bool cli_init()
+{
+	cli_rx_fifo_init(&cli_rx_buff);
+    if ((my_arena_init(&cli_arena) != HAL_OK) ||
+        ((history = my_arena_alloc(&cli_arena, sizeof(HISTORY_S))) == NULL) ||
+        ((cli_script = my_arena_alloc(&cli_arena, CLI_SCRIPT_LEN + 1)) == NULL) ||
+        ((cli_record = my_arena_alloc(&cli_arena, CLI_RECORD_LEN + CLI_RECORD_TAIL_LEN)) == NULL)) {
+        history = NULL;
+        ERR("No memory for the command line buffers.\n");
+        return false;
+    }
+    memset((uint8_t *)history, 0, sizeof(HISTORY_S));
+    cli_script[0] = '\0';
+    cli_script_next = cli_script;
+    cli_record[0] = '@';
+    cli_record_len = 1;
+    cli_machine_mode = false;
+    cli_plain_output(false);
+
+    CLI_commands_count = 0;
+    for(size_t j = 1; j < cli_static_commands_count; j++){
+    	if(strcmp(cli_static_commands[j - 1].pCmd, cli_static_commands[j].pCmd) >= 0){
+    		ERR("Static command table is not sorted at \"%s\", lookups will miss commands.\n",
+    				cli_static_commands[j].pCmd);
+    	}
     }
 
 #ifndef CLI_PASSWORD
@@ -221,214 +352,703 @@ void cli_init()
     greet();
 #endif
 
-    CLI_ADD_CMD("help", cli_help_help, cli_help);
-    CLI_ADD_CMD("cls", cli_clear_help, cli_clear);
-    CLI_ADD_CMD("log", cli_log_help, cli_log);
-
     if(CLI_LAST_LOG_CATEGORY > 32){
     	ERR("Too many log categories defined. The max number of log categories that can be user defined is 31.\n");
     }
 
     LOG(CLI_LOG_SHELL, "Command line successfully initialized.\n");
-
+    return true;
 }
 
 /*
  * Callback function for UART IRQ when it is done receiving a char
  */
 void cli_uart_rxcplt_callback(unsigned char rx){
-	shell_queue_in(&cli_rx_buff, &rx);
+	cli_rx_fifo_push(&cli_rx_buff, rx);
+}
+
+/*
+ * Queue a received chunk, returns how much of it fit
+ */
+size_t cli_uart_rx(const unsigned char *buf, size_t len){
+	return cli_rx_fifo_push_n(&cli_rx_buff, buf, len);
+}
+
+/*
+ * Room left in the RX FIFO, for feeding it in chunks
+ */
+size_t cli_rx_free(void){
+	return cli_rx_fifo_free(&cli_rx_buff);
 }
 
 /**
-  * @brief  handle commands from the terminal
-  * @param  commands
-  * @retval null
+  * @brief  decode one received byte, escape sequences are assembled across calls
+  * @param  esc: decoder state, c: received byte
+  * @retval the key, CLI_KEY_NONE while a sequence is incomplete or for ignored bytes
   */
-static void cli_rx_handle(shell_queue_s *rx_buff)
-{
-    static HANDLE_TYPE_S Handle = {.len = 0, .buff = {0}};
-    uint8_t i = Handle.len;
-    uint8_t cmd_match = false;
-    uint8_t exec_req = false;
-
-    /*  ---------------------------------------
-        Step1: save chars from the terminal
-        ---------------------------------------
-     */
-    bool newChar = true;
-    while(newChar) {
-        if(Handle.len < MAX_LINE_LEN) {  /* check the buffer */
-        	newChar = shell_queue_out(rx_buff, Handle.buff+Handle.len);
-
-            /* new char coming from the terminal, copy it to Handle.buff */
-            if(newChar) {
-                /* KEY_BACKSPACE -->get DELETE key from keyboard */
-                if (Handle.buff[Handle.len] == KEY_BACKSPACE || Handle.buff[Handle.len] == KEY_DEL) {
-                    /* buffer not empty */
-                    if (Handle.len > 0) {
-                        /* delete a char in terminal */
-                        TERMINAL_MOVE_LEFT(1);
-                        TERMINAL_CLEAR_END();
-                        Handle.buff[Handle.len] = '\0';
-                        Handle.len--;
-                    }
-
-                } else if(Handle.buff[Handle.len] == KEY_ENTER){
-                	exec_req = true;
-                	Handle.len++;
-                }else if(strstr((const char *)Handle.buff, KEY_DELETE) != NULL){
-                	strcpy((char *)&Handle.buff[Handle.len-3], (char *)&Handle.buff[Handle.len+1]);
-                	Handle.len -= 3;
-            	}else{
-                    Handle.len++;
-                }
-
-            } else if(cli_password_ok){
-                /* all chars copied to Handle.buff */
-                uint8_t key = 0;
-                uint8_t err = 0xff;
-                char *p_hist_cmd = 0;
-
-                if (Handle.len >= 3) {
-                    if (strstr((const char *)Handle.buff, KEY_UP) != NULL) {
-                        key = 1;
-                        TERMINAL_MOVE_LEFT(Handle.len-3);
-                        TERMINAL_CLEAR_END();
-                        err = cli_history_show(true, &p_hist_cmd);
-                    } else if (strstr((const char *)Handle.buff, KEY_DOWN) != NULL) {
-                        key = 2;
-                        TERMINAL_MOVE_LEFT(Handle.len-3);
-                        TERMINAL_CLEAR_END();
-                        err = cli_history_show(false, &p_hist_cmd);
-                    } else if (strstr((const char *)Handle.buff, KEY_RIGHT) != NULL) {
-                        key = 3;
-                    } else if (strstr((const char *)Handle.buff, KEY_LEFT) != NULL) {
-                        key = 4;
-                    }
-
-                    if (key != 0) {
-                        if (!err) {
-                            memset(&Handle, 0x00, sizeof(Handle));
-                            memcpy(Handle.buff, p_hist_cmd, strlen(p_hist_cmd));
-                            Handle.len = strlen(p_hist_cmd);
-                            Handle.buff[Handle.len] = '\0';
-                            xprintf("%s", Handle.buff);  /* display history command */
-                        } else if (err && (0 != key)) {
-                            /* no history found */
-                            TERMINAL_MOVE_LEFT(Handle.len-3);
-                            TERMINAL_CLEAR_END();
-                            memset(&Handle, 0x00, sizeof(Handle));
-                        }
-                    }
-                }
-
-                if ((key == 0) && (Handle.len > i)) {
-                    /* display char in terminal */
-                    for (; i < Handle.len; i++) {
-                    	xprintf("%c", Handle.buff[i]);
-
-                    }
-                }
-                break;
+static CLI_KEY_E cli_key_decode(ESC_DECODER_S *esc, uint8_t c)
+{
+    CLI_KEY_E key = CLI_KEY_NONE;
+
+    switch (esc->state) {
+    case ESC_STATE_ESC:
+        esc->state = (c == '[') ? ESC_STATE_CSI : (c == 'O') ? ESC_STATE_SS3 : ESC_STATE_NONE;
+        esc->param = 0;
+        return CLI_KEY_NONE;
+    case ESC_STATE_SS3:
+    case ESC_STATE_CSI:
+        if ((esc->state == ESC_STATE_CSI) && (c >= '0') && (c <= '9')) {
+            if (esc->param < 100) esc->param = esc->param * 10 + (c - '0');
+            return CLI_KEY_NONE;
+        }
+        if ((c < 0x40) || (c > 0x7E)) return CLI_KEY_NONE;  /* parameter/intermediate byte, keep going */
+        esc->state = ESC_STATE_NONE;
+        switch (c) {
+        case 'A': return CLI_KEY_UP;
+        case 'B': return CLI_KEY_DOWN;
+        case 'C': return CLI_KEY_RIGHT;
+        case 'D': return CLI_KEY_LEFT;
+        case 'H': return CLI_KEY_HOME;
+        case 'F': return CLI_KEY_END;
+        case '~':
+            switch (esc->param) {
+            case 1: case 7: return CLI_KEY_HOME;
+            case 4: case 8: return CLI_KEY_END;
+            case 3: return CLI_KEY_DELETE;
+            default: return CLI_KEY_NONE;
             }
+        default:
+            return CLI_KEY_NONE;
+        }
+    default:
+        break;
+    }
 
-        } else {
-            /* buffer full */
+    switch (c) {
+    case 0x1B: esc->state = ESC_STATE_ESC; break;
+    case '\r': key = CLI_KEY_ENTER; break;
+    case '\n': key = esc->last_cr ? CLI_KEY_NONE : CLI_KEY_ENTER; break;  /* accept LF and CRLF line ends */
+    case KEY_BACKSPACE:
+    case KEY_DEL: key = CLI_KEY_BACKSPACE; break;
+    case 0x01: key = CLI_KEY_HOME; break;       /* Ctrl-A */
+    case 0x02: key = CLI_KEY_LEFT; break;       /* Ctrl-B */
+    case 0x03: key = CLI_KEY_CANCEL; break;     /* Ctrl-C */
+    case 0x05: key = CLI_KEY_END; break;        /* Ctrl-E */
+    case 0x06: key = CLI_KEY_RIGHT; break;      /* Ctrl-F */
+    case 0x0B: key = CLI_KEY_KILL_END; break;   /* Ctrl-K */
+    case 0x12: key = CLI_KEY_SEARCH; break;     /* Ctrl-R */
+    case 0x15: key = CLI_KEY_KILL_LINE; break;  /* Ctrl-U */
+    default:
+        if ((c >= 0x20) && (c < 0x7F)) key = CLI_KEY_CHAR;
+        break;
+    }
+    esc->last_cr = (c == '\r');
+    return key;
+}
+
+/**
+  * @brief  redraw the line from position 'from' to the end, then put the terminal cursor back
+  */
+static void cli_line_redraw(const HANDLE_TYPE_S *line, uint8_t from)
+{
+    for (uint8_t i = from; i < line->len; i++) {
+        xputc(line->buff[i]);
+    }
+    TERMINAL_CLEAR_END();
+    TERMINAL_MOVE_LEFT(line->len - line->cursor);
+}
+
+/**
+  * @brief  replace the whole line (history recall etc.), cursor goes to the end
+  */
+static void cli_line_replace(HANDLE_TYPE_S *line, const char *text)
+{
+    TERMINAL_MOVE_LEFT(line->cursor);
+    line->len = strlen(text);
+    if (line->len >= MAX_LINE_LEN) line->len = MAX_LINE_LEN - 1;
+    memcpy(line->buff, text, line->len);
+    line->cursor = line->len;
+    cli_line_redraw(line, 0);
+}
+
+/**
+  * @brief  cut the next command off the script, ';' inside quotes doesn't count
+  * @param  p: script position, moved past the command
+  * @retval the command, NUL-terminated
+  */
+static char *cli_script_split(char **p)
+{
+    char *start = *p;
+    char *s = start;
+    char quote = '\0';
+
+    for (; *s != '\0'; s++) {
+        if (quote != '\0') {
+            if (*s == quote) quote = '\0';
+        } else if ((*s == '"') || (*s == '\'')) {
+            quote = *s;
+        } else if (*s == ';') {
+            *s = '\0';
+            *p = s + 1;
+            return start;
+        }
+    }
+    /* past the NUL so that inserted commands don't run into the last argument, see cli_script[] */
+    s[1] = '\0';
+    *p = s + 1;
+    return start;
+}
+
+/**
+  * @brief  split a command into argv in place, "..." and '...' make one argument (quotes removed)
+  * @retval argc
+  */
+static uint8_t cli_tokenize(char *s, char *argv[])
+{
+    uint8_t argc = 0;
+
+    while (true) {
+        while ((*s == ' ') || (*s == '\t')) s++;
+        if (*s == '\0') break;
+        if (argc >= MAX_ARGC) {
+            xprintf(CLI_FONT_RED "Maximum number of arguments is %d. Ignoring the rest of the arguments."CLI_FONT_DEFAULT, MAX_ARGC-1);NL1();
             break;
-        } /*end if(Handle.len > HANDLE_LEN) */
-    } /* end While(1) */
-
-    /*  ---------------------------------------
-        Step2: handle the commands
-        ---------------------------------------
-     */
-    if(exec_req && !cli_password_ok){
+        }
+        if ((*s == '"') || (*s == '\'')) {
+            char quote = *s++;
+            argv[argc++] = s;
+            while ((*s != '\0') && (*s != quote)) s++;
+        } else {
+            argv[argc++] = s;
+            while ((*s != '\0') && (*s != ' ') && (*s != '\t')) s++;
+        }
+        if (*s == '\0') break;
+        *s++ = '\0';
+    }
+    return argc;
+}
+
+/**
+  * @brief  drop the commands not started yet after a failure
+  */
+static void cli_script_stop(void)
+{
+    if (*cli_script_next != '\0') {
+        if (!cli_machine_mode) {
+            xprintf(CLI_FONT_RED "Stopped, skipping: %s" CLI_FONT_DEFAULT, cli_script_next);NL1();
+        }
+        *cli_script_next = '\0';
+    }
+}
+
+/**
+  * @brief  report a finished command, a failure drops the rest of the script
+  */
+static void cli_finish(uint8_t result)
+{
+    if (cli_machine_mode) {
+        cli_record_close(result, cli_micros() - cli_active.start);
+    } else if (result == EXIT_SUCCESS) {
+        xprintf(CLI_FONT_GREEN "(%s returned %d)" CLI_FONT_DEFAULT, cli_active.argv[0], result);NL1();
+    } else {
+        xprintf(CLI_FONT_RED "(%s returned %d)" CLI_FONT_DEFAULT, cli_active.argv[0], result);NL1();
+    }
+    TERMINAL_SHOW_CURSOR();
+    cli_active.entry = NULL;
+    if (result != EXIT_SUCCESS) {
+        cli_script_stop();
+    }
+}
+
+/**
+  * @brief  start one command of the script
+  * @param  command: NUL-terminated, gets tokenized in place
+  */
+static void cli_exec_command(char *command)
+{
+    char *argv[MAX_ARGC];
+    uint8_t argc = cli_tokenize(command, argv);
+    if (argc == 0) {
+        return;
+    }
+
+    /* looking for a match */
+    const COMMAND_S *entry = cli_find_command(argv[0]);
+    if ((entry != NULL) && (entry->pFun != NULL)) {
+        /* call the func., it may yield and come back on later ticks */
+        TERMINAL_HIDE_CURSOR();
+        cli_active.entry = entry;
+        cli_active.start = cli_micros();
+        cli_active.argc = argc;
+        memcpy(cli_active.argv, argv, sizeof(argv));
+        memset(&cli_pt, 0, sizeof(cli_pt));
+        cli_pt.budget_us = entry->budget_us ? entry->budget_us : CLI_DEFAULT_BUDGET_US;
+        cli_resume();
+        return;
+    }
+
+    if (cli_machine_mode) {
+        cli_kv_str("err", "unknown");
+        cli_record_close(CLI_UNKNOWN, 0);
+    } else if (entry != NULL) {
+        /* func. is void */
+        xprintf(CLI_FONT_RED "Command %s exists but no function is associated to it.", argv[0]);NL1();
+    } else {
+        /* no matching command */
+        xprintf("\r\nCommand \"%s\" unknown, try: help", argv[0]);NL1();
+    }
+    cli_script_stop();
+}
+
+/**
+  * @brief  run the script until a command yields or it is done, then prompt
+  */
+static void cli_script_run(void)
+{
+    while (cli_active.entry == NULL) {
+        if (*cli_script_next == '\0') {
+            PRINT_CLI_NAME();
+            return;
+        }
+        cli_exec_command(cli_script_split(&cli_script_next));
+    }
+}
+
+/**
+  * @brief  run a complete command line, commands separated by ';' stop at the first failure
+  * @param  line: NUL-terminated
+  */
+static void cli_exec_line(char *line)
+{
+    if (line[0] == '\0') {
+        PRINT_CLI_NAME();
+        return;
+    }
+    if (!cli_machine_mode) {
+        NL1();
+        cli_history_add(line);
+    }
+    strcpy(cli_script, line);
+    cli_script_next = cli_script;
+    cli_script_run();
+}
+
+/**
+  * @brief  give the active command one time slice, report once it is done
+  */
+static void cli_resume(void)
+{
+    cli_pt.slice_start = cli_micros();
+    cli_pt.yielded = false;
+    uint8_t result = cli_active.entry->pFun(cli_active.argc, cli_active.argv);
+    if (!cli_pt.yielded) {
+        cli_finish(result);
+    }
+}
+
+/**
+  * @brief  insert commands right after the running one, e.g. to expand a macro
+  * @param  commands: ';'-separated
+  * @retval false if the script buffer has no room for them
+  */
+bool cli_script_insert(const char *commands)
+{
+    size_t len = strlen(commands);
+    size_t rest = strlen(cli_script_next);
+
+    if ((size_t)(cli_script_next - cli_script) + len + 1 + rest + 1 > CLI_SCRIPT_LEN) {
+        return false;
+    }
+    memmove(cli_script_next + len + 1, cli_script_next, rest + 1);
+    memcpy(cli_script_next, commands, len);
+    cli_script_next[len] = ';';
+    return true;
+}
+
+/**
+  * @brief  apply one decoded key to the line being edited
+  */
+static void cli_line_edit(HANDLE_TYPE_S *line, CLI_KEY_E key, uint8_t c)
+{
+    char *p_hist_cmd = NULL;
+
+    if (!cli_password_ok) {
+        /* no echo and no editing until the password is entered */
+        if ((key == CLI_KEY_CHAR) && (line->len < MAX_LINE_LEN - 1)) {
+            line->buff[line->len++] = c;
+        } else if (key == CLI_KEY_ENTER) {
+            line->buff[line->len] = '\0';
 #ifdef CLI_PASSWORD
-    	Handle.buff[Handle.len-1] = '\0';
-    	if(strcmp((char *)Handle.buff, XSTRING(CLI_PASSWORD)) == 0){
-    		cli_password_ok = true;
-    		greet();
-    	}
-    	Handle.len = 0;
+            if (strcmp((char *)line->buff, XSTRING(CLI_PASSWORD)) == 0) {
+                cli_password_ok = true;
+                greet();
+            }
 #else
-    	cli_password_ok = true;
-    	greet();
+            cli_password_ok = true;
+            greet();
 #endif
-    }else if(exec_req && (Handle.len == 1)) {
-        /* KEY_ENTER -->ENTER key from terminal */
-    	PRINT_CLI_NAME();
-        Handle.len = 0;
-    } else if(exec_req && Handle.len > 1) {  /* check for the length of command */
-		NL1();
-		Handle.buff[Handle.len - 1] = '\0';
-		cli_history_add((char *)Handle.buff);
-		char *command = strtok((char *)Handle.buff, " \t");
-
-		/* looking for a match */
-		for(i = 0; i < MAX_COMMAND_NB; i++) {
-			if(0 == strcmp(command, CLI_commands[i].pCmd)) {
-				cmd_match = true;
-
-				//Split arguments string to argc/argv
-				uint8_t argc = 1;
-				char 	*argv[MAX_ARGC];
-				argv[0] = command;
-
-				char *token = strtok(NULL, " \t");
-				while(token != NULL){
-					if(argc >= MAX_ARGC){
-						xprintf(CLI_FONT_RED "Maximum number of arguments is %d. Ignoring the rest of the arguments."CLI_FONT_DEFAULT, MAX_ARGC-1);NL1();
-						break;
-					}
-					argv[argc] = token;
-					argc++;
-					token = strtok(NULL, " \t");
-				}
-
-				if(CLI_commands[i].pFun != NULL) {
-					/* call the func. */
-					TERMINAL_HIDE_CURSOR();
-					uint8_t result = CLI_commands[i].pFun(argc, argv);
-
-					if(result == EXIT_SUCCESS){
-						xprintf(CLI_FONT_GREEN "(%s returned %d)" CLI_FONT_DEFAULT, command, result);NL1();
-					}else{
-						xprintf(CLI_FONT_RED "(%s returned %d)" CLI_FONT_DEFAULT, command, result);NL1();
-					}
-					TERMINAL_SHOW_CURSOR();
-					break;
-				} else {
-					/* func. is void */
-					xprintf(CLI_FONT_RED "Command %s exists but no function is associated to it.", command);NL1();
-				}
-			}
-		}
+            line->len = 0;
+            line->cursor = 0;
+        }
+        return;
+    }
 
-		if(!cmd_match) {
-			/* no matching command */
-			xprintf("\r\nCommand \"%s\" unknown, try: help", Handle.buff);NL1();
-		}
+    if (cli_machine_mode) {
+        /* no echo and no editing, only what a script would send */
+        if ((key == CLI_KEY_CHAR) && (line->len < MAX_LINE_LEN - 1)) {
+            line->buff[line->len++] = c;
+        } else if ((key == CLI_KEY_BACKSPACE) && (line->len > 0)) {
+            line->len--;
+        } else if (key == CLI_KEY_CANCEL) {
+            line->len = 0;
+        } else if (key == CLI_KEY_ENTER) {
+            line->buff[line->len] = '\0';
+            line->len = 0;
+            cli_exec_line((char *)line->buff);
+        }
+        line->cursor = line->len;
+        return;
+    }
+
+    switch (key) {
+    case CLI_KEY_CHAR:
+        if (line->len >= MAX_LINE_LEN - 1) {
+            xputc('\a');  /* full */
+            break;
+        }
+        if (line->cursor < line->len) {
+            memmove(&line->buff[line->cursor + 1], &line->buff[line->cursor], line->len - line->cursor);
+        }
+        line->buff[line->cursor] = c;
+        line->len++;
+        line->cursor++;
+        if (line->cursor == line->len) {
+            xputc(c);  /* appending, the common case */
+        } else {
+            cli_line_redraw(line, line->cursor - 1);
+        }
+        break;
+    case CLI_KEY_BACKSPACE:
+        if (line->cursor == 0) break;
+        memmove(&line->buff[line->cursor - 1], &line->buff[line->cursor], line->len - line->cursor);
+        line->len--;
+        line->cursor--;
+        TERMINAL_MOVE_LEFT(1);
+        cli_line_redraw(line, line->cursor);
+        break;
+    case CLI_KEY_DELETE:
+        if (line->cursor == line->len) break;
+        memmove(&line->buff[line->cursor], &line->buff[line->cursor + 1], line->len - line->cursor - 1);
+        line->len--;
+        cli_line_redraw(line, line->cursor);
+        break;
+    case CLI_KEY_LEFT:
+        if (line->cursor == 0) break;
+        line->cursor--;
+        TERMINAL_MOVE_LEFT(1);
+        break;
+    case CLI_KEY_RIGHT:
+        if (line->cursor == line->len) break;
+        line->cursor++;
+        TERMINAL_MOVE_RIGHT(1);
+        break;
+    case CLI_KEY_HOME:
+        TERMINAL_MOVE_LEFT(line->cursor);
+        line->cursor = 0;
+        break;
+    case CLI_KEY_END:
+        TERMINAL_MOVE_RIGHT(line->len - line->cursor);
+        line->cursor = line->len;
+        break;
+    case CLI_KEY_KILL_END:
+        line->len = line->cursor;
+        TERMINAL_CLEAR_END();
+        break;
+    case CLI_KEY_KILL_LINE:
+        cli_line_replace(line, "");
+        break;
+    case CLI_KEY_UP:
+    case CLI_KEY_DOWN:
+        if (!cli_history_show(key == CLI_KEY_UP, &p_hist_cmd)) {
+            cli_line_replace(line, p_hist_cmd);
+        }
+        break;
+    case CLI_KEY_SEARCH:
+        /* the text left of the cursor is the prefix, the cursor stays there so repeating goes further back */
+        if (!cli_history_search((const char *)line->buff, line->cursor, &p_hist_cmd)) {
+            uint8_t prefix = line->cursor;
+            cli_line_replace(line, p_hist_cmd);
+            TERMINAL_MOVE_LEFT(line->len - prefix);
+            line->cursor = prefix;
+        } else {
+            xputc('\a');
+        }
+        break;
+    case CLI_KEY_CANCEL:
+        xprintf("^C");
+        line->len = 0;
+        line->cursor = 0;
+        history->show = 0;
+        PRINT_CLI_NAME();
+        break;
+    case CLI_KEY_ENTER:
+        line->buff[line->len] = '\0';
+        line->len = 0;
+        line->cursor = 0;
+        cli_exec_line((char *)line->buff);
+        break;
+    default:
+        break;
+    }
+}
 
-		Handle.len = 0;
-		PRINT_CLI_NAME();
+/**
+  * @brief  look for Ctrl-C anywhere in the queued input, both the span up to the wrap point and the part after it
+  * @param  rx_buff
+  * @retval bytes up to and including the first Ctrl-C, 0 if there is none
+  */
+static size_t cli_rx_find_cancel(cli_rx_fifo_t *rx_buff)
+{
+    uint8_t *span;
+    size_t first = cli_rx_fifo_peek(rx_buff, &span);
+    size_t count = cli_rx_fifo_count(rx_buff);  /* after the peek, the ISR may have pushed more in between */
+    const uint8_t *hit = memchr(span, 0x03, first);
 
+    if (hit != NULL) {
+        return (size_t)(hit - span) + 1;
     }
+    hit = memchr(rx_buff->buf, 0x03, count - first);
+    return (hit != NULL) ? first + (size_t)(hit - rx_buff->buf) + 1 : 0;
+}
 
+/**
+  * @brief  handle commands from the terminal, constant work per received byte (except for in-line edits)
+  * @param  commands
+  * @retval null
+  */
+static void cli_rx_handle(cli_rx_fifo_t *rx_buff)
+{
+    static HANDLE_TYPE_S Handle = {.len = 0, .cursor = 0, .buff = {0}};
+    static ESC_DECODER_S esc = {.state = ESC_STATE_NONE};
+    uint8_t c;
+    size_t cancel;
+
+    if (cli_active.entry != NULL) {
+        /* Only Ctrl-C gets through while a command runs, the rest waits for the prompt; typed-ahead input before it goes with the command */
+        if ((cancel = cli_rx_find_cancel(rx_buff)) > 0) {
+            cli_rx_fifo_consume(rx_buff, cancel);
+            if (cli_machine_mode) {
+                cli_kv_str("err", "aborted");
+                cli_record_close(CLI_ABORTED, cli_micros() - cli_active.start);
+            } else {
+                xprintf(CLI_FONT_RED "^C (%s aborted)" CLI_FONT_DEFAULT, cli_active.argv[0]);NL1();
+            }
+            TERMINAL_SHOW_CURSOR();
+            cli_active.entry = NULL;
+            *cli_script_next = '\0';
+        } else {
+            cli_resume();
+        }
+        if (cli_active.entry != NULL) {
+            return;
+        }
+        cli_script_run();
+        if (cli_active.entry != NULL) {
+            return;
+        }
+    }
 
-    if(Handle.len >= MAX_LINE_LEN) {
-        /* full, so restart the count */
-    	xprintf(CLI_FONT_RED "\r\nMax command length is %d.\r\n" CLI_FONT_DEFAULT, MAX_LINE_LEN-1);
-    	PRINT_CLI_NAME();
-        Handle.len = 0;
+    while ((cli_active.entry == NULL) && cli_rx_fifo_pop(rx_buff, &c)) {
+        CLI_KEY_E key = cli_key_decode(&esc, c);
+        if (key != CLI_KEY_NONE) {
+            cli_line_edit(&Handle, key, c);
+        }
     }
 }
 
 void cli_run(void)
 {
+    if (history == NULL) {
+        return;
+    }
     cli_rx_handle(&cli_rx_buff);
 }
 
+bool cli_busy(void)
+{
+    return cli_active.entry != NULL;
+}
+
+void cli_yield(void)
+{
+    cli_pt.yielded = true;
+}
+
+bool cli_pt_expired(void)
+{
+    return (uint32_t)(cli_micros() - cli_pt.slice_start) >= cli_pt.budget_us;
+}
+
+/**
+  * @brief  room for one " key=value" pair at the end of the record, a pair that doesn't fit is dropped
+  * @param  value_len: upper bound of the formatted value
+  * @retval where to xsprintf() it, NULL if it doesn't fit
+  */
+static char *cli_record_reserve(const char *key, size_t value_len)
+{
+    if (cli_record_len + 1 + strlen(key) + 1 + value_len > CLI_RECORD_LEN) {
+        cli_record_truncated = true;
+        return NULL;
+    }
+    return &cli_record[cli_record_len];
+}
+
+/**
+  * @brief  account for the pair just formatted at the end of the record
+  */
+static void cli_record_commit(void)
+{
+    cli_record_len += strlen(&cli_record[cli_record_len]);
+}
+
+/**
+  * @brief  end a command in machine mode: the record line with its result and execution time, sent in one piece
+  */
+static void cli_record_close(int result, uint32_t us)
+{
+    xsprintf(&cli_record[cli_record_len], "%s rc=%d us=%lu\n",
+            cli_record_truncated ? " truncated=1" : "", result, (unsigned long)us);
+    xputs(cli_record);
+    cli_record_len = 1;
+    cli_record_truncated = false;
+}
+
+void cli_kv_u32(const char *key, uint32_t val)
+{
+    char *pair;
+
+    if (cli_machine_mode) {
+        if ((pair = cli_record_reserve(key, 10)) != NULL) {
+            xsprintf(pair, " %s=%lu", key, (unsigned long)val);
+            cli_record_commit();
+        }
+    } else {
+        xprintf("%s = %lu\n", key, (unsigned long)val);
+    }
+}
+
+void cli_kv_i32(const char *key, int32_t val)
+{
+    char *pair;
+
+    if (cli_machine_mode) {
+        if ((pair = cli_record_reserve(key, 11)) != NULL) {
+            xsprintf(pair, " %s=%ld", key, (long)val);
+            cli_record_commit();
+        }
+    } else {
+        xprintf("%s = %ld\n", key, (long)val);
+    }
+}
+
+void cli_kv_f32(const char *key, float val)
+{
+    char *pair;
+
+    if (cli_machine_mode) {
+        if ((pair = cli_record_reserve(key, CLI_RECORD_F32_LEN)) != NULL) {
+            xsprintf(pair, " %s=%f", key, val);
+            cli_record_commit();
+        }
+    } else {
+        xprintf("%s = %f\n", key, val);
+    }
+}
+
+/**
+  * @brief  length of a string value on the record line, quoted if it has a space, '=', '"', '\\' or a control character
+  * @retval 0 if it goes as is, else the quoted length with its escapes
+  */
+static size_t cli_record_quoted_len(const char *val)
+{
+    size_t len = 2;
+    bool quote = false;
+
+    for (const unsigned char *p = (const unsigned char *)val; *p != '\0'; p++) {
+        if ((*p == '"') || (*p == '\\') || (*p == '\n') || (*p == '\r') || (*p == '\t')) {
+            len += 2;
+            quote = true;
+        } else if ((*p < 0x20) || (*p == 0x7F)) {
+            len += 4;
+            quote = true;
+        } else {
+            len += 1;
+            quote = quote || (*p == ' ') || (*p == '=');
+        }
+    }
+    return quote ? len : 0;
+}
+
+/* Escapes inside the quotes: \" \\ \n \r \t, other control characters as \xHH */
+static void cli_record_quote(char *dst, const char *val)
+{
+    *dst++ = '"';
+    for (const unsigned char *p = (const unsigned char *)val; *p != '\0'; p++) {
+        switch (*p) {
+        case '"':	*dst++ = '\\'; *dst++ = '"'; break;
+        case '\\':	*dst++ = '\\'; *dst++ = '\\'; break;
+        case '\n':	*dst++ = '\\'; *dst++ = 'n'; break;
+        case '\r':	*dst++ = '\\'; *dst++ = 'r'; break;
+        case '\t':	*dst++ = '\\'; *dst++ = 't'; break;
+        default:
+            if ((*p < 0x20) || (*p == 0x7F)) {
+                *dst++ = '\\';
+                *dst++ = 'x';
+                *dst++ = "0123456789ABCDEF"[*p >> 4];
+                *dst++ = "0123456789ABCDEF"[*p & 0x0F];
+            } else {
+                *dst++ = (char)*p;
+            }
+            break;
+        }
+    }
+    *dst++ = '"';
+    *dst = '\0';
+}
+
+void cli_kv_str(const char *key, const char *val)
+{
+    char *pair;
+    size_t quoted_len;
+
+    if (cli_machine_mode) {
+        quoted_len = cli_record_quoted_len(val);
+        if ((pair = cli_record_reserve(key, quoted_len ? quoted_len : strlen(val))) != NULL) {
+            if (quoted_len) {
+                xsprintf(pair, " %s=", key);
+                cli_record_quote(pair + strlen(pair), val);
+            } else {
+                xsprintf(pair, " %s=%s", key, val);
+            }
+            cli_record_commit();
+        }
+    } else {
+        xprintf("%s = %s\n", key, val);
+    }
+}
+
+/* Default for applications without a VT100 filter: colours stay in */
+__attribute__((weak)) void cli_plain_output(bool plain)
+{
+	(void)plain;
+}
+
+/* Default for applications without a time source: never expires */
+__attribute__((weak)) uint32_t cli_micros(void)
+{
+    return 0;
+}
+
 void greet(void){
     NL1();
     TERMINAL_BACK_DEFAULT(); /* set terminal background color: black */
@@ -472,26 +1092,32 @@ void greet(void){
   * @param  para addr. & length
   * @retval True means OK
   */
+static void cli_help_list(const COMMAND_S *table, size_t count)
+{
+    for(size_t i = 0; i < count; i++) {
+    	xprintf("[%s]", table[i].pCmd);NL1();
+        if (table[i].pHelp) {
+            xprintf(table[i].pHelp);NL2();
+        }
+    }
+}
+
 uint8_t cli_help(int argc, char *argv[])
 {
 	if(argc == 1){
-	    for(size_t i = 0; i < MAX_COMMAND_NB; i++) {
-	    	if(strcmp(CLI_commands[i].pCmd, "") != 0){
-		    	xprintf("[%s]", CLI_commands[i].pCmd);NL1();
-		        if (CLI_commands[i].pHelp) {
-		            xprintf(CLI_commands[i].pHelp);NL2();
-		        }
-	    	}
-	    }
+		cli_help_list(cli_builtin_commands, CLI_BUILTIN_COMMANDS_COUNT);
+		cli_help_list(cli_static_commands, cli_static_commands_count);
+		cli_help_list(CLI_commands, CLI_commands_count);
 	    return EXIT_SUCCESS;
 	}else if(argc == 2){
-	    for(size_t i = 0; i < MAX_COMMAND_NB; i++) {
-	    	if(strcmp(CLI_commands[i].pCmd, argv[1]) == 0){
-		    	xprintf("[%s]", CLI_commands[i].pCmd);NL1();
-	    		xprintf(CLI_commands[i].pHelp);NL1();
-	    		return EXIT_SUCCESS;
+		const COMMAND_S *entry = cli_find_command(argv[1]);
+		if(entry != NULL){
+	    	xprintf("[%s]", entry->pCmd);NL1();
+	    	if (entry->pHelp) {
+	    		xprintf(entry->pHelp);NL1();
 	    	}
-	    }
+	    	return EXIT_SUCCESS;
+		}
 	    xprintf("No help found for command %s.", argv[1]);NL1();
 	    return EXIT_FAILURE;
 	}else{
@@ -525,21 +1151,78 @@ uint8_t cli_clear(int argc, char *argv[])
     return EXIT_SUCCESS;
 }
 
-void cli_add_command(const char *command, const char *help, uint8_t (*exec)(int argc, char *argv[])){
-	size_t i = 0;
-	for(; i < MAX_COMMAND_NB; i++){
-		if(strcmp(CLI_commands[i].pCmd, "") == 0){
-			CLI_commands[i].pCmd = command;
-			CLI_commands[i].pFun = exec;
-			CLI_commands[i].pHelp = help;
-			break;
+/**
+  * @brief  switch between the interactive terminal and machine mode
+  */
+uint8_t cli_mode(int argc, char *argv[]){
+	if(argc < 2){
+		cli_kv_str("mode", cli_machine_mode ? "machine" : "human");
+		return EXIT_SUCCESS;
+	}
+	if(strcmp(argv[1], "machine") == 0){
+		cli_machine_mode = true;
+	}else if(strcmp(argv[1], "human") == 0){
+		cli_machine_mode = false;
+	}else{
+		xprintf("Unknown mode \"%s\". Use \"help %s\" for usage.\n", argv[1], argv[0]);
+		return EXIT_FAILURE;
+	}
+	cli_plain_output(cli_machine_mode);
+	return EXIT_SUCCESS;
+}
+
+static const COMMAND_S *cli_find_sorted(const COMMAND_S *table, size_t count, const char *command)
+{
+	size_t lo = 0;
+	size_t hi = count;
+	while(lo < hi){
+		size_t mid = lo + (hi - lo) / 2;
+		int cmp = strcmp(command, table[mid].pCmd);
+		if(cmp == 0){
+			return &table[mid];
+		}else if(cmp < 0){
+			hi = mid;
+		}else{
+			lo = mid + 1;
+		}
+	}
+	return NULL;
+}
+
+/**
+  * @brief  look a command up: builtins and the static table first (binary search), then the runtime overlay
+  * @param  command name
+  * @retval the entry, NULL if not found
+  */
+const COMMAND_S *cli_find_command(const char *command)
+{
+	const COMMAND_S *entry = cli_find_sorted(cli_builtin_commands, CLI_BUILTIN_COMMANDS_COUNT, command);
+	if(entry == NULL){
+		entry = cli_find_sorted(cli_static_commands, cli_static_commands_count, command);
+	}
+	for(size_t i = 0; (entry == NULL) && (i < CLI_commands_count); i++){
+		if(strcmp(command, CLI_commands[i].pCmd) == 0){
+			entry = &CLI_commands[i];
 		}
 	}
-	if(i == MAX_COMMAND_NB){
+	return entry;
+}
+
+/**
+  * @brief  register a command at runtime, in addition to the static table
+  */
+void cli_add_command(const char *command, const char *help, uint8_t (*exec)(int argc, char *argv[])){
+	if(CLI_commands_count >= MAX_COMMAND_NB){
 		ERR("Cannot add command %s, max number of commands "
 				"reached. The maximum number of command is set to %d.\n" CLI_FONT_DEFAULT,
 				command, MAX_COMMAND_NB); NL1();
+		return;
 	}
+	CLI_commands[CLI_commands_count].pCmd = command;
+	CLI_commands[CLI_commands_count].pFun = exec;
+	CLI_commands[CLI_commands_count].pHelp = help;
+	CLI_commands[CLI_commands_count].budget_us = 0;
+	CLI_commands_count++;
 	LOG(CLI_LOG_SHELL, "Command %s added to shell.\n", command);
 }
 
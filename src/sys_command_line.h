@@ -14,11 +14,13 @@
 #define __SYS_COMMAND_LINE_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <xprintf.h>
 #include <string.h>
 
-#include "sys_queue.h"
+#include "my_spsc.h"
 #include "vt100.h"
+#include "my_dlog.h"
 
 _BEGIN_STD_C
 
@@ -26,21 +28,39 @@ _BEGIN_STD_C
  *  Macro config
  */
 #define CLI_ENABLE          true            	/* command line enable/disable */
-#define HISTORY_MAX         10                  /* maximum number of history command */
-#define MAX_COMMAND_NB		32
+#define HISTORY_BUF_SIZE    256                 /* bytes of history, each command takes its length + 1 */
+#define MAX_COMMAND_NB		8					/* runtime-registered commands, on top of the static table */
 #define MAX_ARGC			8
-#define MAX_LINE_LEN 		80
+#define MAX_LINE_LEN 		128
+#define CLI_SCRIPT_LEN		256					/* line being run plus expanded macros */
+#ifndef CLI_RX_BUFF_LEN
+#define CLI_RX_BUFF_LEN		32					/* RX FIFO between the UART and the shell, a power of two */
+#endif
+#define CLI_PT_STATE_SIZE	32					/* bytes of state a resumable command keeps across yields */
+#define CLI_DEFAULT_BUDGET_US	1000			/* time slice of a resumable command per cli_run() */
+#ifndef CLI_RECORD_LEN
+#define CLI_RECORD_LEN		384					/* machine mode record: '@' and the key=value pairs of one command */
+#endif
 
 #ifndef CLI_DISABLE
     #define CLI_INIT(...)       cli_init(__VA_ARGS__)
     #define CLI_RUN(...)        cli_run(__VA_ARGS__)
 	#define CLI_ADD_CMD(...)	cli_add_command(__VA_ARGS__)
 #else
-    #define CLI_INIT(...)       ;
+    #define CLI_INIT(...)       (true)
     #define CLI_RUN(...)        ;
 	#define CLI_ADD_CMD(...)	;
 #endif /* CLI_DISABLE */
 
+#if MY_DLOG_ENABLE
+/* Deferred variants: only an ID and the raw arguments leave the device, see my_dlog.h */
+#define ERR(fmt, ...)	MY_DLOG(MY_DLOG_LEVEL_ERR, __FILE__ ":" XSTRING(__LINE__) ": " fmt, ##__VA_ARGS__)
+#define LOG(LOG_CAT, fmt, ...)											\
+						if((1<<LOG_CAT)&cli_log_stat) {					\
+							MY_DLOG(LOG_CAT, fmt, ##__VA_ARGS__);		\
+						}
+#define DBG(fmt, ...)	MY_DLOG(MY_DLOG_LEVEL_DBG, __FILE__ ":" XSTRING(__LINE__) ": " fmt, ##__VA_ARGS__)
+#else
 #define ERR(fmt, ...)  do {												\
                             xprintf(								\
 								CLI_FONT_RED							\
@@ -64,6 +84,7 @@ _BEGIN_STD_C
 							CLI_FONT_DEFAULT,							\
                                 __FILE__, __LINE__, ##__VA_ARGS__);		\
                         } while(0)
+#endif
 
 #define DIE(fmt, ...)   do {											\
                             TERMINAL_FONT_RED();						\
@@ -81,10 +102,99 @@ _BEGIN_STD_C
 #define XSTRING(s) STRING(s)
 
 #ifdef CLI_NAME
-#define PRINT_CLI_NAME()	do { xprintf(CLI_FONT_DEFAULT "\n" XSTRING(CLI_NAME) "$ "); } while(0)
+#define PRINT_CLI_NAME()	do { if (!cli_machine_mode) xprintf(CLI_FONT_DEFAULT "\n" XSTRING(CLI_NAME) "$ "); } while(0)
 #else
-#define PRINT_CLI_NAME()	do { xprintf(CLI_FONT_DEFAULT "\n#$ "); } while(0)
+#define PRINT_CLI_NAME()	do { if (!cli_machine_mode) xprintf(CLI_FONT_DEFAULT "\n#$ "); } while(0)
 #endif
+/*
+ * Command entry
+ */
+typedef struct {
+    const char *pCmd;
+    const char *pHelp;
+    uint8_t (*pFun)(int argc, char *argv[]);
+    uint32_t budget_us;		/* time slice for resumable commands, 0 = CLI_DEFAULT_BUDGET_US */
+} COMMAND_S;
+
+/*
+ * Static command table, required from the application (kept in flash): dbg_console.c on the target,
+ * host/host_commands.c in the native build. An application without commands defines an empty one, count 0.
+ * Must be sorted by name in strcmp() order, it is binary-searched; cli_init() reports a misplaced entry.
+ * There is deliberately no weak default: gcc folds a weak const's initializer into its users (with or without
+ * -flto), the shell would keep using the empty default and report every application command as unknown.
+ */
+extern const COMMAND_S cli_static_commands[];
+extern const size_t cli_static_commands_count;
+#define CLI_COMMAND(name, help, fn)	{ (name), (help), (fn), 0 }
+#define CLI_COMMAND_BUDGET(name, help, fn, budget_us)	{ (name), (help), (fn), (budget_us) }
+
+/*
+ * Resumable commands.
+ * A handler that calls cli_yield() before returning is called again with the same argv on the next cli_run(),
+ * its return value is ignored. Input stays queued (except Ctrl-C, which aborts it) and the prompt only comes back
+ * once it returns without yielding; all 256 result codes stay the handler's own.
+ * The CLI_PT_* macros turn a handler into a protothread: locals do not survive a yield, keep them in the state block
+ * (zeroed on the first call). No switch statements around a yield, it is one already.
+ *
+ *	uint8_t cmd(int argc, char *argv[]) {
+ *		CLI_PT_BEGIN(my_state_t, st);
+ *		for (st->i = 0; st->i < N; st->i++) {
+ *			step(st->i);
+ *			CLI_PT_YIELD_IF_EXPIRED();
+ *		}
+ *		CLI_PT_END();
+ *		return 0;
+ *	}
+ */
+#define CLI_UNKNOWN			(-1)			/* machine mode rc of an unknown command, handlers return 0..255 */
+#define CLI_ABORTED			(-2)			/* machine mode rc of a command stopped by Ctrl-C */
+
+typedef struct {
+	uint32_t lc;			/* where to resume, 0 = from the start */
+	bool yielded;			/* set by cli_yield() during the current call */
+	uint32_t slice_start;	/* cli_micros() when the current slice started */
+	uint32_t budget_us;
+	uint32_t state[CLI_PT_STATE_SIZE / sizeof(uint32_t)];
+} CLI_PT_S;
+
+extern CLI_PT_S cli_pt;
+
+#define CLI_PT_BEGIN(type, name)												\
+						_Static_assert(sizeof(type) <= CLI_PT_STATE_SIZE,		\
+								"CLI_PT_STATE_SIZE too small for " #type);		\
+						type *name = (type *)cli_pt.state;						\
+						switch (cli_pt.lc) { case 0:
+#define CLI_PT_YIELD()	do { cli_pt.lc = __LINE__; cli_yield(); return 0; case __LINE__:; } while(0)
+#define CLI_PT_YIELD_IF_EXPIRED()	do { if (cli_pt_expired()) CLI_PT_YIELD(); } while(0)
+#define CLI_PT_END()	default: break; }
+
+/**
+  * @brief  time source for command budgets, weak: without it resumable commands run to completion in one go
+  */
+uint32_t	cli_micros(void);
+
+/**
+  * @brief  from a command handler: call it again on the next cli_run() instead of finishing it
+  */
+void		cli_yield(void);
+
+/**
+  * @brief  whether the running resumable command has used up its time slice
+  */
+bool		cli_pt_expired(void);
+
+/**
+  * @brief  whether a resumable command is still running (input is not being consumed)
+  */
+bool		cli_busy(void);
+
+/**
+  * @brief  queue ';'-separated commands to run right after the calling one, e.g. a macro body.
+  *         They stop at the first failure like the rest of the line.
+  * @retval false if they don't fit in CLI_SCRIPT_LEN
+  */
+bool		cli_script_insert(const char *commands);
+
 enum cli_log_categories {
 	CLI_LOG_SHELL = 0,
 
@@ -101,13 +211,36 @@ extern char *cli_logs_names[];
 
 extern uint32_t cli_log_stat;
 
+/*
+ * Machine mode ("mode machine"), for test rigs: no echo, prompt, banner or colours, and every command ends with
+ * one record line "@ key=value ... rc=<result> us=<execution time>". Commands put their results on it with
+ * cli_kv_*() (printed as "key = value" lines in the normal mode), other output still goes out as is before it:
+ * the pairs are collected in a buffer and the whole line is sent when the command ends, so that logs printed
+ * meanwhile can't land inside it. Pairs beyond CLI_RECORD_LEN are dropped and the record gets "truncated=1".
+ * A string value with a space, '=', '"', '\\' or a control character is quoted, with \" \\ \n \r \t and \xHH escapes.
+ * rc is the handler's result (0..255), or negative when the shell ended the command: CLI_UNKNOWN, CLI_ABORTED.
+ */
+#define CLI_RECORD_F32_LEN	48					/* longest "%f" value, -FLT_MAX with 6 decimals */
+#define CLI_RECORD_TAIL_LEN	48					/* " truncated=1 rc=-2 us=4294967295\n" and the NUL */
+extern bool cli_machine_mode;
+
+void		cli_kv_u32(const char *key, uint32_t val);
+void		cli_kv_i32(const char *key, int32_t val);
+void		cli_kv_f32(const char *key, float val);
+void		cli_kv_str(const char *key, const char *val);
+
+/**
+  * @brief  mode change hook, weak: the application strips VT100 sequences from the console output while plain is set
+  */
+void		cli_plain_output(bool plain);
+
 
 /**
   * @brief  command line init.
   * @param  handle to uart peripheral
-  * @retval null
+  * @retval false if the "cli" arena couldn't hold the buffers, the shell then ignores its input
   */
-void 		cli_init(void);
+bool 		cli_init(void);
 
 /**
   * @brief  command line task, schedule by sys. every 50ms
@@ -118,7 +251,11 @@ void 		cli_run(void);
 
 void 		cli_add_command(const char *command, const char *help, uint8_t (*exec)(int argc, char *argv[]));
 
+const COMMAND_S *cli_find_command(const char *command);
+
 void cli_uart_rxcplt_callback(unsigned char rx);
+size_t cli_uart_rx(const unsigned char *buf, size_t len);
+size_t cli_rx_free(void);
 
 _END_STD_C
 
@@ -35,6 +35,9 @@
 #include <newlib.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdbool.h>
+
+#include "my_mem.h"
 
 #undef errno
 extern int errno;
@@ -225,14 +228,10 @@ void *_sbrk(ptrdiff_t incr)
 {
     char *old_brk = brk;
 
-    if (&__heap_start[0] == &__heap_end[0]) {
-        return NULL;
-    }
-
-    if ((brk += incr) < &__heap_end[0]) {
-        brk += incr;
-    } else {
-        brk = &__heap_end[0];
+    if (!my_mem_sbrk_allowed(incr) || (incr > (&__heap_end[0] - brk))) {
+        errno = ENOMEM;
+        return (void *)-1;
     }
+    brk += incr;
     return old_brk;
 }
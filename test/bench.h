@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/*
+ * Timing for the host benchmarks (test_bench_*). Cycles are the build machine's TSC where there is one,
+ * nanoseconds otherwise: compare numbers between variants measured in the same run, not with the target.
+ */
+
+static inline uint64_t bench_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+static inline uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return bench_ns();
+#endif
+}
+//One Unity message per result ("pio test -e native -v" shows them), include unity.h first
+#define BENCH_REPORT(fmt, ...) \
+    do \
+    { \
+        char bench_line_[160]; \
+        snprintf(bench_line_, sizeof(bench_line_), "BENCH " fmt, ##__VA_ARGS__); \
+        TEST_MESSAGE(bench_line_); \
+    } while (0)
@@ -0,0 +1,70 @@
+#include "sys_command_line.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * libFuzzer target for the shell: every input is a byte stream from the UART, fed through cli_uart_rx()
+ * and cli_run() in RX FIFO sized chunks like cli_task_callback() does. Not a "pio test" suite (needs clang):
+ *
+ *   clang -g -O1 -std=gnu11 -fsanitize=fuzzer,address,undefined -Isrc -Isrc/host -D_BEGIN_STD_C= -D_END_STD_C= \
+ *       src/sys_command_line.c src/my_mem.c src/host/host_commands.c src/host/host_io.c src/host/host_mem.c \
+ *       test/fuzz/fuzz_cli.c -o fuzz_cli
+ *   ./fuzz_cli -max_len=512 corpus/
+ *
+ * Built with -DFUZZ_STANDALONE (any compiler) it runs the files given on the command line instead,
+ * to replay a crash or a corpus under gcc's sanitizers.
+ */
+
+static void discard(int c)
+{
+    (void)c;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    static bool initialized = false;
+    //Ends any escape sequence (ESC [ Z is ignored from every decoder state), then Ctrl-C drops the line
+    static const unsigned char reset[] = { 0x1B, '[', 'Z', 0x03 };
+
+    if (!initialized)
+    {
+        xdev_out(discard);
+        cli_init();
+        initialized = true;
+    }
+    while (size > 0)
+    {
+        size_t len = cli_uart_rx(data, size);
+        data += len;
+        size -= len;
+        cli_run();
+    }
+    while (cli_busy() || (cli_rx_free() < CLI_RX_BUFF_LEN)) cli_run();
+    //The shell is global state: leave it at an empty prompt so that every input starts from the same place
+    cli_uart_rx(reset, sizeof(reset));
+    while (cli_rx_free() < CLI_RX_BUFF_LEN) cli_run();
+    cli_machine_mode = false;
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+int main(int argc, char** argv)
+{
+    static uint8_t buf[1 << 16];
+
+    for (int i = 1; i < argc; i++)
+    {
+        FILE* f = fopen(argv[i], "rb");
+        if (f == NULL)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+        size_t len = fread(buf, 1, sizeof(buf), f);
+        fclose(f);
+        LLVMFuzzerTestOneInput(buf, len);
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,121 @@
+#include <unity.h>
+
+#include "sys_command_line.h"
+
+#include "../bench.h"
+
+/*
+ * Shell throughput on the build machine: complete commands per second through cli_uart_rx()/cli_run(),
+ * and the cost of one received byte (cli_run() per byte) while editing a line, the worst case being
+ * in-line inserts and history recall that redraw the rest of the line
+ */
+
+#define COMMANDS 20000
+
+static uint32_t nop_calls;
+
+static void discard(int c)
+{
+    (void)c;
+}
+static uint8_t nop(int argc, char** argv)
+{
+    (void)argc;
+    (void)argv;
+    nop_calls++;
+    return 0;
+}
+static void feed(const char* s, size_t len)
+{
+    while (len > 0)
+    {
+        size_t n = cli_uart_rx((const unsigned char*)s, len);
+        s += n;
+        len -= n;
+        cli_run();
+    }
+    while (cli_busy() || (cli_rx_free() < CLI_RX_BUFF_LEN)) cli_run();
+}
+
+void setUp(void)
+{
+    xdev_out(discard);
+    cli_init();
+    cli_add_command("nop", NULL, nop);
+    nop_calls = 0;
+}
+void tearDown(void)
+{
+    xdev_out(NULL);
+}
+
+static void commands_per_second(bool machine)
+{
+    static const char line[] = "nop arg1 arg2 arg3\r";
+
+    cli_machine_mode = machine;
+    uint64_t start = bench_ns();
+    for (int i = 0; i < COMMANDS; i++) feed(line, sizeof(line) - 1);
+    uint64_t ns = bench_ns() - start;
+    cli_machine_mode = false;
+    TEST_ASSERT_EQUAL_UINT32(COMMANDS, nop_calls);
+    BENCH_REPORT("%s mode: %.0f commands/s, %.0f ns per byte", machine ? "machine" : "human",
+        COMMANDS * 1e9 / (double)ns, (double)ns / (COMMANDS * (sizeof(line) - 1)));
+}
+
+void test_commands_per_second_human(void)
+{
+    commands_per_second(false);
+}
+void test_commands_per_second_machine(void)
+{
+    commands_per_second(true);
+}
+
+void test_cycles_per_byte(void)
+{
+    //A recorded session: typing, cursor moves, in-line inserts near the start of a long line, history, Ctrl-R
+    static const char session[] =
+        "nop first command with a few arguments\r"
+        "nop 0123456789 0123456789 0123456789 0123456789 0123456789 0123456789 0123456789 0123456789\x01"
+        "\x1b[C\x1b[C\x1b[C\x1b[Cinserted near the start \x1b[3~\x1b[3~\x05\x7f\x7f\r"
+        "\x1b[A\x1b[A\x1b[B\x15nop\x12\x12\x12\x0b\r"
+        "help nop\r";
+    static uint64_t best[sizeof(session) - 1]; //Per byte, the fastest of all rounds: the host's noise removed
+    uint64_t worst_edit = 0;
+    uint64_t worst_any = 0;
+    uint64_t total = 0;
+
+    memset(best, 0xFF, sizeof(best));
+    for (int round = 0; round < 200; round++)
+    {
+        for (size_t i = 0; i < sizeof(session) - 1; i++)
+        {
+            unsigned char c = (unsigned char)session[i];
+            cli_uart_rx(&c, 1);
+            uint64_t start = bench_cycles();
+            cli_run();
+            uint64_t cycles = bench_cycles() - start;
+            while (cli_busy()) cli_run();
+            if (cycles < best[i]) best[i] = cycles;
+        }
+    }
+    for (size_t i = 0; i < sizeof(session) - 1; i++)
+    {
+        total += best[i];
+        if (best[i] > worst_any) worst_any = best[i];
+        if ((session[i] != '\r') && (best[i] > worst_edit)) worst_edit = best[i];
+    }
+    TEST_ASSERT_EQUAL_UINT32(200 * 3, nop_calls);
+    BENCH_REPORT("per byte: %.0f cycles mean, %llu worst while editing, %llu worst with command dispatch",
+        (double)total / (sizeof(session) - 1), (unsigned long long)worst_edit, (unsigned long long)worst_any);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_commands_per_second_human);
+    RUN_TEST(test_commands_per_second_machine);
+    RUN_TEST(test_cycles_per_byte);
+    return UNITY_END();
+}
@@ -0,0 +1,118 @@
+#include <unity.h>
+
+#include "sys_command_line.h"
+
+#include "../bench.h"
+
+/*
+ * Key decoder and line editor throughput over recorded terminal sessions (xterm, CR and CRLF line ends,
+ * CSI and SS3 cursor keys), fed through cli_uart_rx()/cli_run() as one block and split into 1-byte chunks:
+ * every session has to run the same commands either way, and the cost per byte must not grow with the line
+ */
+
+#define ROUNDS 2000
+
+typedef struct
+{
+    const char* name;
+    const char* bytes;
+} session_t;
+
+static const session_t sessions[] = {
+    { "typing", "rec typed line with a few words\r" "rec another one\r\n" "rec third\r" },
+    { "cursor keys", "rec word\x1b[D\x1b[D\x1b[D\x1b[DX\x1b[C\x1b[C\x1bOD\x1bOCY\x1b[F\x1b[H\x1b[4~Z\r" },
+    { "delete and kill", "rec abcdefgh\x1b[1~\x1b[C\x1b[C\x1b[C\x1b[C\x1b[3~\x1b[3~\x7f\x08\x05\x01\x0b" "rec kept\r" },
+    { "history", "rec one\rrec two\r\x1b[A\x1b[A\x1b[B\r\x1bOA\x15rec r\x12\r" },
+    { "line 16", "rec 0123456789a\r" },
+    { "line 64", "rec 0123456789abcdef0123456789abcdef0123456789abcdef0123456789a\r" },
+    { "line 120", "rec 0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+                  "0123456789abcdef0123456789abcdef0123456789abcdef01234\r" },
+};
+
+static char rec_log[256];
+
+static void discard(int c)
+{
+    (void)c;
+}
+static uint8_t rec(int argc, char** argv)
+{
+    size_t used = strlen(rec_log);
+    (void)argv;
+    if (used + 2 < sizeof(rec_log))
+    {
+        rec_log[used] = (char)('0' + argc); //Enough to tell the lines apart
+        rec_log[used + 1] = '\0';
+    }
+    return 0;
+}
+static void feed(const char* s, size_t len, size_t chunk)
+{
+    while (len > 0)
+    {
+        size_t n = cli_uart_rx((const unsigned char*)s, (len < chunk) ? len : chunk);
+        s += n;
+        len -= n;
+        cli_run();
+    }
+    while (cli_busy() || (cli_rx_free() < CLI_RX_BUFF_LEN)) cli_run();
+}
+
+void setUp(void)
+{
+    xdev_out(discard);
+    cli_init();
+    cli_add_command("rec", NULL, rec);
+    rec_log[0] = '\0';
+}
+void tearDown(void)
+{
+    xdev_out(NULL);
+}
+
+void test_split_sequences_decode_the_same(void)
+{
+    for (size_t i = 0; i < sizeof(sessions) / sizeof(sessions[0]); i++)
+    {
+        char whole[sizeof(rec_log)];
+
+        setUp();
+        feed(sessions[i].bytes, strlen(sessions[i].bytes), CLI_RX_BUFF_LEN);
+        strcpy(whole, rec_log);
+        TEST_ASSERT_TRUE_MESSAGE(whole[0] != '\0', sessions[i].name);
+        setUp();
+        feed(sessions[i].bytes, strlen(sessions[i].bytes), 1);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(whole, rec_log, sessions[i].name);
+    }
+}
+
+void test_throughput(void)
+{
+    double per_byte[sizeof(sessions) / sizeof(sessions[0])];
+
+    for (size_t i = 0; i < sizeof(sessions) / sizeof(sessions[0]); i++)
+    {
+        size_t len = strlen(sessions[i].bytes);
+        uint64_t best = UINT64_MAX;
+        for (int round = 0; round < ROUNDS; round++)
+        {
+            setUp();
+            uint64_t start = bench_cycles();
+            feed(sessions[i].bytes, len, CLI_RX_BUFF_LEN);
+            uint64_t cycles = bench_cycles() - start;
+            if (cycles < best) best = cycles;
+        }
+        per_byte[i] = (double)best / len;
+        BENCH_REPORT("%-16s %4u bytes, %6.1f cycles per byte", sessions[i].name, (unsigned)len, per_byte[i]);
+    }
+    //Constant work per byte: a 120 character line costs about what a 16 character one does, per byte
+    TEST_ASSERT_LESS_THAN(2.0 * per_byte[4], per_byte[6]);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_split_sequences_decode_the_same);
+    RUN_TEST(test_throughput);
+    return UNITY_END();
+}
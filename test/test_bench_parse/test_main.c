@@ -0,0 +1,94 @@
+#include <unity.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "my_parse.h"
+
+#include "../bench.h"
+
+/*
+ * Cycles per value, my_parse against the C library's sscanf() (what the console used before) and strtof().
+ * Linked code size is a target question: tools/parse_size.py builds the same comparison with the RISC-V toolchain.
+ */
+
+#define ROUNDS 20000
+
+static const char* const floats[] = {
+    "0.5", "1.25", "-3.75", "100", "0.001", "123.456", "3.14159265", "-2.5e-5", "6.02214076e23", "1.17549435e-38"
+};
+static const char* const integers[] = { "0", "7", "1000", "65535", "123456789", "4294967295" };
+
+static volatile float float_sink;
+static volatile uint32_t u32_sink;
+
+static double best_cycles(int which, const char* s)
+{
+    uint64_t best = UINT64_MAX;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        float f = 0.0f;
+        unsigned long u = 0;
+        uint32_t u32 = 0;
+        uint64_t start = bench_cycles();
+        switch (which)
+        {
+        case 0: my_parse_float(s, &f); break;
+        case 1: sscanf(s, "%f", &f); break;
+        case 2: f = strtof(s, NULL); break;
+        case 3: my_parse_u32(s, &u32); break;
+        case 4: sscanf(s, "%lu", &u); break;
+        default: u = strtoul(s, NULL, 0); break;
+        }
+        uint64_t cycles = bench_cycles() - start;
+        float_sink = f;
+        u32_sink = u32 + (uint32_t)u;
+        if (cycles < best) best = cycles;
+    }
+    return (double)best;
+}
+
+void setUp(void)
+{
+}
+void tearDown(void)
+{
+}
+
+void test_float_cycles(void)
+{
+    double total[3] = { 0 };
+
+    for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++)
+    {
+        double c[3];
+        for (int which = 0; which < 3; which++) total[which] += (c[which] = best_cycles(which, floats[i]));
+        BENCH_REPORT("%-16s my_parse_float %5.0f  sscanf %5.0f  strtof %5.0f", floats[i], c[0], c[1], c[2]);
+    }
+    size_t n = sizeof(floats) / sizeof(floats[0]);
+    BENCH_REPORT("float mean       my_parse_float %5.0f  sscanf %5.0f  strtof %5.0f cycles per value",
+        total[0] / n, total[1] / n, total[2] / n);
+    TEST_ASSERT_LESS_THAN(total[1], total[0]);
+}
+
+void test_integer_cycles(void)
+{
+    double total[3] = { 0 };
+
+    for (size_t i = 0; i < sizeof(integers) / sizeof(integers[0]); i++)
+    {
+        for (int which = 0; which < 3; which++) total[which] += best_cycles(3 + which, integers[i]);
+    }
+    size_t n = sizeof(integers) / sizeof(integers[0]);
+    BENCH_REPORT("u32 mean         my_parse_u32   %5.0f  sscanf %5.0f  strtoul %5.0f cycles per value",
+        total[0] / n, total[1] / n, total[2] / n);
+    TEST_ASSERT_LESS_THAN(total[1], total[0]);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_float_cycles);
+    RUN_TEST(test_integer_cycles);
+    return UNITY_END();
+}
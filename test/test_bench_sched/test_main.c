@@ -0,0 +1,134 @@
+#include <unity.h>
+
+#include "my_sched.h"
+#include "host_clock.h"
+
+#include "../bench.h"
+
+/*
+ * Main loop cost of the deadline heap against polling one soft timer per job (what main() did before
+ * my_sched), hundreds of periodic tasks on the fake clock. A pass where nothing is due should cost the
+ * same whatever the task count; a dispatch costs O(log n).
+ */
+
+#define LOOP_STEP_US 50 //Simulated main loop pass
+#define RUN_US 2000000u
+
+static my_sched_task_t tasks[MY_SCHED_MAX_TASKS];
+static soft_timer_32 polled[MY_SCHED_MAX_TASKS];
+static uint32_t periods[MY_SCHED_MAX_TASKS];
+static uint32_t calls;
+
+static uint32_t rng_state = 0x6C8E9CF5u;
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void job(void* ctx)
+{
+    (void)ctx;
+    calls++;
+}
+//check_soft_timer_32() from my_hal.c, the baseline
+static bool check_polled(soft_timer_32* t)
+{
+    bool ret = (get_micros_32() - t->last_time) > t->interval;
+    if (ret) t->last_time = get_micros_32();
+    return ret;
+}
+
+static double run_heap(size_t count)
+{
+    host_clock_set(0);
+    my_sched_init();
+    for (size_t i = 0; i < count; i++)
+    {
+        tasks[i] = (my_sched_task_t)MY_SCHED_TASK("bench", job, periods[i]);
+        TEST_ASSERT_TRUE(my_sched_add_periodic(&(tasks[i])));
+    }
+    calls = 0;
+    uint64_t elapsed = 0;
+    for (uint32_t t = 0; t < RUN_US; t += LOOP_STEP_US)
+    {
+        host_clock_advance(LOOP_STEP_US);
+        uint64_t start = bench_ns();
+        my_sched_run();
+        elapsed += bench_ns() - start;
+    }
+    return (double)elapsed / (RUN_US / LOOP_STEP_US);
+}
+static double run_polled(size_t count)
+{
+    host_clock_set(0);
+    for (size_t i = 0; i < count; i++) polled[i] = (soft_timer_32){ .interval = periods[i] };
+    calls = 0;
+    uint64_t elapsed = 0;
+    for (uint32_t t = 0; t < RUN_US; t += LOOP_STEP_US)
+    {
+        host_clock_advance(LOOP_STEP_US);
+        uint64_t start = bench_ns();
+        for (size_t i = 0; i < count; i++)
+        {
+            if (check_polled(&(polled[i]))) job(NULL);
+        }
+        elapsed += bench_ns() - start;
+    }
+    return (double)elapsed / (RUN_US / LOOP_STEP_US);
+}
+
+void setUp(void)
+{
+    for (size_t i = 0; i < MY_SCHED_MAX_TASKS; i++) periods[i] = 1000u + (rng() % 100u) * 1000u; //1 to 100 ms
+}
+void tearDown(void)
+{
+}
+
+void test_loop_cost_vs_task_count(void)
+{
+    for (size_t count = 16; count <= MY_SCHED_MAX_TASKS; count *= 4)
+    {
+        double polled_ns = run_polled(count);
+        uint32_t polled_calls = calls;
+        double heap_ns = run_heap(count);
+
+        BENCH_REPORT("%4u tasks: polled %8.1f ns, my_sched %6.1f ns per loop pass (%u vs %u runs)",
+            (unsigned)count, polled_ns, heap_ns, (unsigned)polled_calls, (unsigned)calls);
+        //Every task ran on its grid: no overruns, one run per period
+        for (size_t i = 0; i < count; i++)
+        {
+            TEST_ASSERT_EQUAL_UINT32(0, tasks[i].overruns);
+            TEST_ASSERT_EQUAL_UINT32(RUN_US / periods[i], tasks[i].runs);
+        }
+    }
+}
+
+//A pass with nothing due: peek at the heap top and leave
+void test_idle_pass(void)
+{
+    const uint32_t passes = 1000000;
+
+    for (size_t count = 16; count <= MY_SCHED_MAX_TASKS; count *= 8)
+    {
+        run_heap(count);
+        uint32_t next;
+        TEST_ASSERT_TRUE(my_sched_get_next_deadline(&next));
+        host_clock_set(next - 1);
+        uint64_t start = bench_cycles();
+        for (uint32_t i = 0; i < passes; i++) my_sched_run();
+        double cycles = (double)(bench_cycles() - start) / passes;
+        BENCH_REPORT("%4u tasks: idle my_sched_run() %.1f cycles", (unsigned)count, cycles);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_loop_cost_vs_task_count);
+    RUN_TEST(test_idle_pass);
+    return UNITY_END();
+}
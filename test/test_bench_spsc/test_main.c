@@ -0,0 +1,107 @@
+#include <unity.h>
+
+#include <stddef.h>
+
+#include "my_spsc.h"
+#include "sys_queue.h"
+
+#include "../bench.h"
+
+/*
+ * The shell RX FIFO before and after the move to my_spsc.h: sys_queue.[ch] next to this file are the old
+ * queue as it was in src/, kept here as the baseline only. Same 32 bytes, same pattern of one byte in,
+ * two out every other byte; plus the bulk path the ring added, which the old queue didn't have.
+ */
+
+#define OPS 20000000u
+
+MY_SPSC_DEFINE(bench_ring, uint8_t, SHELL_QUEUE_LENGTH)
+
+static shell_queue_s old_queue;
+static bench_ring_t ring;
+static volatile uint32_t sink;
+
+void setUp(void)
+{
+    shell_queue_init(&old_queue);
+    bench_ring_init(&ring);
+}
+void tearDown(void)
+{
+}
+
+void test_byte_ops(void)
+{
+    uint32_t sum_old = 0;
+    uint32_t sum_ring = 0;
+    uint8_t value;
+
+    uint64_t start = bench_ns();
+    for (uint32_t i = 0; i < OPS; i++)
+    {
+        uint8_t in = (uint8_t)i;
+        shell_queue_in(&old_queue, &in);
+        if (i & 1u)
+        {
+            if (shell_queue_out(&old_queue, &value)) sum_old += value;
+            if (shell_queue_out(&old_queue, &value)) sum_old += value;
+        }
+    }
+    double old_ns = (double)(bench_ns() - start) / OPS;
+
+    start = bench_ns();
+    for (uint32_t i = 0; i < OPS; i++)
+    {
+        bench_ring_push(&ring, (uint8_t)i);
+        if (i & 1u)
+        {
+            if (bench_ring_pop(&ring, &value)) sum_ring += value;
+            if (bench_ring_pop(&ring, &value)) sum_ring += value;
+        }
+    }
+    double ring_ns = (double)(bench_ns() - start) / OPS;
+    sink = sum_old + sum_ring;
+
+    BENCH_REPORT("byte in/out: sys_queue %.2f ns, my_spsc %.2f ns per push", old_ns, ring_ns);
+    TEST_ASSERT_EQUAL_UINT32(sum_old, sum_ring); //Both saw the same bytes
+}
+
+void test_bulk_ops(void)
+{
+    uint8_t chunk[16];
+    uint8_t out[16];
+    uint32_t sum_old = 0;
+    uint32_t sum_ring = 0;
+
+    for (size_t i = 0; i < sizeof(chunk); i++) chunk[i] = (uint8_t)(i * 7u);
+
+    uint64_t start = bench_ns();
+    for (uint32_t i = 0; i < OPS / sizeof(chunk); i++) //A UART chunk byte by byte, as the old cli task did
+    {
+        for (size_t j = 0; j < sizeof(chunk); j++) shell_queue_in(&old_queue, &(chunk[j]));
+        for (size_t j = 0; j < sizeof(chunk); j++) shell_queue_out(&old_queue, &(out[j]));
+        sum_old += out[3];
+    }
+    double old_ns = (double)(bench_ns() - start) / OPS;
+
+    start = bench_ns();
+    for (uint32_t i = 0; i < OPS / sizeof(chunk); i++)
+    {
+        bench_ring_push_n(&ring, chunk, sizeof(chunk));
+        bench_ring_pop_n(&ring, out, sizeof(out));
+        sum_ring += out[3];
+    }
+    double ring_ns = (double)(bench_ns() - start) / OPS;
+    sink = sum_old + sum_ring;
+
+    BENCH_REPORT("16-byte chunks: sys_queue %.2f ns, my_spsc push_n/pop_n %.2f ns per byte", old_ns, ring_ns);
+    TEST_ASSERT_EQUAL_UINT32(sum_old, sum_ring);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_byte_ops);
+    RUN_TEST(test_bulk_ops);
+    return UNITY_END();
+}
@@ -0,0 +1,97 @@
+#include <unity.h>
+
+#include "my_twheel.h"
+#include "host_clock.h"
+
+#include "../bench.h"
+
+/*
+ * Arm/cancel and tick cost against the number of pending timers: the wheel has no per-timer work
+ * outside of the timers that expire or cascade, so both should stay flat from a handful to thousands.
+ */
+
+#define MAX_PENDING 16384
+#define ARM_OPS 1000000u
+#define TICKS 20000u
+
+static my_twheel_timer_t timers[MAX_PENDING];
+static my_twheel_timer_t probe;
+static uint32_t fired;
+
+static uint32_t rng_state = 0x9E3779B9u;
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+//Expired timers come back with a new random timeout, so the pending count stays put while ticking
+static void rearm(my_twheel_timer_t* timer, void* ctx)
+{
+    (void)ctx;
+    fired++;
+    my_twheel_arm(timer, 1000u + rng() % 60000000u);
+}
+
+static void fill(size_t count)
+{
+    host_clock_set(0);
+    my_twheel_init();
+    for (size_t i = 0; i < count; i++)
+    {
+        my_twheel_setup(&(timers[i]), rearm, NULL);
+        my_twheel_arm(&(timers[i]), 1000u + rng() % 60000000u); //1 ms to 1 min, every level of the wheel
+    }
+    my_twheel_setup(&probe, rearm, NULL);
+}
+
+void setUp(void)
+{
+}
+void tearDown(void)
+{
+}
+
+void test_cost_vs_pending(void)
+{
+    double first_arm = 0.0;
+    double arm_ns = 0.0;
+
+    for (size_t count = 16; count <= MAX_PENDING; count *= 4)
+    {
+        fill(count);
+
+        uint64_t start = bench_ns();
+        for (uint32_t i = 0; i < ARM_OPS; i++)
+        {
+            my_twheel_arm(&probe, 1000u + (i & 0xFFFFu) * 997u);
+            my_twheel_cancel(&probe);
+        }
+        arm_ns = (double)(bench_ns() - start) / ARM_OPS;
+        if (count == 16) first_arm = arm_ns;
+
+        fired = 0;
+        start = bench_ns();
+        for (uint32_t i = 0; i < TICKS; i++)
+        {
+            host_clock_advance(MY_TWHEEL_TICK_US);
+            my_twheel_tick();
+        }
+        double tick_ns = (double)(bench_ns() - start) / TICKS;
+
+        BENCH_REPORT("%5u pending: arm+cancel %6.1f ns, tick %7.1f ns (%.2f expired per tick)",
+            (unsigned)count, arm_ns, tick_ns, (double)fired / TICKS);
+        TEST_ASSERT_EQUAL_UINT32(count, my_twheel_get_pending());
+    }
+    //Flat, with room for cache effects of the bigger timer arrays on the build machine
+    TEST_ASSERT_LESS_THAN(4.0 * first_arm, arm_ns);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_cost_vs_pending);
+    return UNITY_END();
+}
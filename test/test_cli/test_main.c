@@ -0,0 +1,412 @@
+#include <unity.h>
+
+#include <stdlib.h>
+
+#include "sys_command_line.h"
+
+/*
+ * Shell behaviour through its public entry points: bytes in through cli_uart_rx()/cli_run(),
+ * console output captured through xdev_out()
+ */
+
+typedef struct
+{
+    uint32_t step;
+} resumable_state_t;
+
+static char out[8192];
+static size_t out_len;
+static uint32_t resumable_calls;
+static uint8_t resumable_result;
+static char recorded[MAX_LINE_LEN];
+static char rec_log[1024]; //Every run of rec, "|args"
+
+static void capture(int c)
+{
+    if (out_len < sizeof(out) - 1) out[out_len++] = (char)c;
+    out[out_len] = '\0';
+}
+static void clear_output(void)
+{
+    out_len = 0;
+    out[0] = '\0';
+}
+static int occurrences(const char* s)
+{
+    int n = 0;
+    for (const char* p = strstr(out, s); p != NULL; p = strstr(p + 1, s)) n++;
+    return n;
+}
+//Everything queued has been handled and no command is running
+static void feed(const char* s)
+{
+    size_t len = strlen(s);
+    while (len > 0)
+    {
+        size_t n = cli_uart_rx((const unsigned char*)s, len);
+        s += n;
+        len -= n;
+        cli_run();
+    }
+    for (int guard = 0; cli_busy() || (cli_rx_free() < CLI_RX_BUFF_LEN); guard++)
+    {
+        TEST_ASSERT_LESS_THAN_MESSAGE(1000, guard, "shell never got back to the prompt");
+        cli_run();
+    }
+}
+//Yields on every call until it has been called three times, then returns resumable_result
+static uint8_t resumable(int argc, char** argv)
+{
+    (void)argc;
+    (void)argv;
+    resumable_calls++;
+    CLI_PT_BEGIN(resumable_state_t, st);
+    for (st->step = 0; st->step < 2; st->step++)
+    {
+        CLI_PT_YIELD();
+    }
+    CLI_PT_END();
+    return resumable_result;
+}
+
+//Keeps its arguments, to see which line actually ran
+static uint8_t rec(int argc, char** argv)
+{
+    recorded[0] = '\0';
+    for (int i = 1; i < argc; i++)
+    {
+        if (i > 1) strcat(recorded, " ");
+        strcat(recorded, argv[i]);
+    }
+    if (strlen(rec_log) + 1 + strlen(recorded) < sizeof(rec_log))
+    {
+        strcat(rec_log, "|");
+        strcat(rec_log, recorded);
+    }
+    return 0;
+}
+//Expands to "insert <commands>"
+static uint8_t insert(int argc, char** argv)
+{
+    return ((argc == 2) && cli_script_insert(argv[1])) ? 0 : 1;
+}
+
+void setUp(void)
+{
+    xdev_out(capture);
+    TEST_ASSERT_TRUE(cli_init());
+    cli_add_command("rec", NULL, rec);
+    cli_add_command("resumable", NULL, resumable);
+    cli_add_command("insert", NULL, insert);
+    recorded[0] = '\0';
+    rec_log[0] = '\0';
+    resumable_calls = 0;
+    resumable_result = 0;
+    clear_output();
+}
+void tearDown(void)
+{
+    cli_machine_mode = false;
+    xdev_out(NULL);
+}
+
+void test_yield_resumes_until_done(void)
+{
+    feed("resumable\r");
+    TEST_ASSERT_EQUAL_UINT32(3, resumable_calls);
+    TEST_ASSERT_FALSE(cli_busy());
+    TEST_ASSERT_NOT_NULL(strstr(out, "(resumable returned 0)"));
+}
+
+//Result codes that used to mean "yield" or a shell condition are plain results now
+void test_any_result_code_finishes(void)
+{
+    static const uint8_t codes[] = { 0xFF, 0xFE, 0xFD };
+
+    for (size_t i = 0; i < sizeof(codes); i++)
+    {
+        char line[32];
+        resumable_calls = 0;
+        resumable_result = codes[i];
+        clear_output();
+        feed("resumable\r");
+        TEST_ASSERT_EQUAL_UINT32(3, resumable_calls);
+        snprintf(line, sizeof(line), "(resumable returned %u)", codes[i]);
+        TEST_ASSERT_NOT_NULL(strstr(out, line));
+    }
+    cli_machine_mode = true; //No echo of the input, no "skipping" note
+    clear_output();
+    feed("fail 255;echo after\r");
+    TEST_ASSERT_NOT_NULL(strstr(out, " rc=255 "));
+    TEST_ASSERT_EQUAL_INT(0, occurrences("after")); //The batch stopped at the failure
+    clear_output();
+    feed("fail 0;echo after\r");
+    TEST_ASSERT_EQUAL_INT(1, occurrences("after"));
+}
+
+//Shell-level endings are negative, apart from anything a handler can return
+void test_machine_mode_rc(void)
+{
+    cli_machine_mode = true;
+    feed("fail 254\r");
+    TEST_ASSERT_NOT_NULL(strstr(out, "@ rc=254 us="));
+    clear_output();
+    feed("nosuchcommand\r");
+    TEST_ASSERT_NOT_NULL(strstr(out, "@ err=unknown rc=-1 us="));
+    clear_output();
+    cli_uart_rx((const unsigned char*)"resumable\r", 10);
+    cli_run();
+    feed("\x03");
+    TEST_ASSERT_NOT_NULL(strstr(out, "@ err=aborted rc=-2 us="));
+}
+
+//Pairs and other output while the command runs, the record line itself stays in one piece
+static uint8_t chatty(int argc, char** argv)
+{
+    cli_kv_u32("first", 1);
+    xprintf("log line\n");
+    cli_kv_str("second", "two words");
+    for (int i = (argc > 1) ? atoi(argv[1]) : 0; i > 0; i--)
+    {
+        cli_kv_str("filler", "0123456789012345678901234567890123456789"); //48 bytes as a pair
+    }
+    return 0;
+}
+
+void test_machine_mode_record_is_one_line(void)
+{
+    cli_add_command("chatty", NULL, chatty);
+    cli_machine_mode = true;
+    feed("chatty\r");
+    TEST_ASSERT_NOT_NULL(strstr(out, "log line\n@ first=1 second=\"two words\" rc=0 us="));
+    TEST_ASSERT_EQUAL_INT(1, occurrences("\n@"));
+
+    //More pairs than CLI_RECORD_LEN holds: dropped and flagged, the line still ends properly
+    clear_output();
+    feed("chatty 6\r");
+    TEST_ASSERT_NULL(strstr(out, " truncated=1"));
+    TEST_ASSERT_EQUAL_INT(6, occurrences(" filler="));
+    clear_output();
+    feed("chatty 20;chatty 20\r");
+    TEST_ASSERT_EQUAL_INT(2, occurrences(" truncated=1 rc=0 us="));
+    TEST_ASSERT_EQUAL_INT(4, occurrences("\n")); //Two log lines, two records
+    TEST_ASSERT_LESS_OR_EQUAL(2 * (CLI_RECORD_LEN + CLI_RECORD_TAIL_LEN + sizeof("log line\n")), out_len);
+}
+
+//A stored macro body, as "macro" lists it
+static uint8_t quoting(int argc, char** argv)
+{
+    (void)argc;
+    (void)argv;
+    cli_kv_str("plain", "word");
+    cli_kv_str("body", "echo \"a b\";x\\y\n\x01");
+    return 0;
+}
+
+//Quotes, backslashes and control characters can't end the value or the record early
+void test_machine_mode_string_escapes(void)
+{
+    cli_add_command("quoting", NULL, quoting);
+    cli_machine_mode = true;
+    feed("quoting\r");
+    TEST_ASSERT_NOT_NULL(strstr(out, "@ plain=word body=\"echo \\\"a b\\\";x\\\\y\\n\\x01\" rc=0 us="));
+    TEST_ASSERT_EQUAL_INT(1, occurrences("\n"));
+}
+
+void test_ctrl_c_aborts_a_yielding_command(void)
+{
+    cli_uart_rx((const unsigned char*)"resumable\r", 10);
+    cli_run();
+    TEST_ASSERT_TRUE(cli_busy());
+    feed("\x03");
+    TEST_ASSERT_FALSE(cli_busy());
+    TEST_ASSERT_EQUAL_UINT32(1, resumable_calls);
+    TEST_ASSERT_NOT_NULL(strstr(out, "(resumable aborted)"));
+}
+
+//Typed-ahead input queued in front of Ctrl-C goes with the aborted command
+void test_ctrl_c_behind_typed_input(void)
+{
+    cli_uart_rx((const unsigned char*)"resumable\r", 10);
+    cli_run();
+    TEST_ASSERT_TRUE(cli_busy());
+    feed("x\x03");
+    TEST_ASSERT_FALSE(cli_busy());
+    TEST_ASSERT_EQUAL_UINT32(1, resumable_calls);
+    TEST_ASSERT_NOT_NULL(strstr(out, "(resumable aborted)"));
+    clear_output();
+    feed("rec y\r");
+    TEST_ASSERT_EQUAL_STRING("y", recorded);
+}
+
+//Ctrl-C past the FIFO wrap point, after the contiguous span
+void test_ctrl_c_in_wrapped_part_of_the_fifo(void)
+{
+    char pending[CLI_RX_BUFF_LEN];
+    size_t len = CLI_RX_BUFF_LEN - 10 + 1; //"resumable\r" already went through, this ends at index 0 again
+
+    cli_uart_rx((const unsigned char*)"resumable\r", 10);
+    cli_run();
+    TEST_ASSERT_TRUE(cli_busy());
+    memset(pending, 'x', len - 1);
+    pending[len - 1] = 0x03;
+    TEST_ASSERT_EQUAL(len, cli_uart_rx((const unsigned char*)pending, len));
+    cli_run();
+    TEST_ASSERT_FALSE(cli_busy());
+    TEST_ASSERT_EQUAL_UINT32(1, resumable_calls);
+    TEST_ASSERT_EQUAL_UINT32(CLI_RX_BUFF_LEN, cli_rx_free());
+}
+
+#define CTRL_R "\x12"
+
+void test_history_recall(void)
+{
+    feed("rec one\r");
+    feed("rec two\r");
+    feed("rec two\r"); //Same as the latest one, not stored again
+    feed("rec three\r");
+    feed(KEY_UP KEY_UP "\r");
+    TEST_ASSERT_EQUAL_STRING("two", recorded);
+    //The recalled line ran and went on top: two, three, two, one going back
+    feed(KEY_UP KEY_UP KEY_UP KEY_UP "\r");
+    TEST_ASSERT_EQUAL_STRING("one", recorded);
+    feed(KEY_UP KEY_UP KEY_UP KEY_UP KEY_DOWN KEY_DOWN "\r");
+    TEST_ASSERT_EQUAL_STRING("two", recorded);
+}
+
+//Entries of 30 characters take 31 bytes: they wrap around the ring end at a different offset every time
+void test_history_evicts_oldest_whole_entries(void)
+{
+    const int entries = 40;
+    const int kept = HISTORY_BUF_SIZE / 31;
+    char line[48];
+
+    for (int i = 0; i < entries; i++)
+    {
+        snprintf(line, sizeof(line), "rec %03d abcdefghijklmnopqrstuv\r", i);
+        TEST_ASSERT_EQUAL_UINT32(31, strlen(line));
+        feed(line);
+    }
+    for (int back = 1; back <= kept + 5; back++)
+    {
+        char expected[32];
+        int n = (back <= kept) ? (entries - back) : (entries - kept); //Older than the oldest kept: stays there
+        line[0] = '\0';
+        for (int i = 0; i < back; i++) strcat(line, KEY_UP);
+        feed(line);
+        feed("\r");
+        snprintf(expected, sizeof(expected), "%03d abcdefghijklmnopqrstuv", n);
+        TEST_ASSERT_EQUAL_STRING(expected, recorded);
+        //Running it put it on top again: redo the same history for the next step
+        for (int i = entries - kept; i < entries; i++)
+        {
+            snprintf(line, sizeof(line), "rec %03d abcdefghijklmnopqrstuv\r", i);
+            feed(line);
+        }
+    }
+}
+
+void test_history_search(void)
+{
+    feed("rec alpha 1\r");
+    feed("rec beta\r");
+    feed("rec alpha 2\r");
+    feed("rec gamma\r");
+    feed("rec al" CTRL_R "\r");
+    TEST_ASSERT_EQUAL_STRING("alpha 2", recorded);
+    //Running it put "rec alpha 2" on top again, it matches twice before "rec alpha 1"
+    feed("rec al" CTRL_R CTRL_R "\r");
+    TEST_ASSERT_EQUAL_STRING("alpha 2", recorded);
+    feed("rec al" CTRL_R CTRL_R CTRL_R "\r");
+    TEST_ASSERT_EQUAL_STRING("alpha 1", recorded);
+    feed("rec z" CTRL_R "\r"); //No match: the line stays as typed
+    TEST_ASSERT_EQUAL_STRING("z", recorded);
+}
+
+void test_batch_split(void)
+{
+    cli_machine_mode = true;
+    feed("rec a;rec b c;  ;;rec d\r");
+    TEST_ASSERT_EQUAL_STRING("|a|b c|d", rec_log);
+    TEST_ASSERT_EQUAL_INT(3, occurrences("@ rc=0 "));
+    rec_log[0] = '\0';
+    feed("rec \"x;y\" 'z ; w';rec \"it's\"\r"); //';' and the other quote character inside quotes are text
+    TEST_ASSERT_EQUAL_STRING("|x;y z ; w|it's", rec_log);
+    rec_log[0] = '\0';
+    feed("rec \"unterminated;rec x\r");
+    TEST_ASSERT_EQUAL_STRING("|unterminated;rec x", rec_log);
+}
+
+void test_batch_stops_at_first_failure(void)
+{
+    cli_machine_mode = true;
+    feed("rec 1;fail 7;rec 2\r");
+    TEST_ASSERT_EQUAL_STRING("|1", rec_log);
+    TEST_ASSERT_NOT_NULL(strstr(out, "@ rc=7 "));
+    rec_log[0] = '\0';
+    clear_output();
+    feed("rec 1;nosuchcommand;rec 2\r");
+    TEST_ASSERT_EQUAL_STRING("|1", rec_log);
+    TEST_ASSERT_NOT_NULL(strstr(out, " rc=-1 "));
+    rec_log[0] = '\0';
+    feed("rec again\r"); //Nothing left over from the stopped line
+    TEST_ASSERT_EQUAL_STRING("|again", rec_log);
+}
+
+void test_tokenize(void)
+{
+    feed("rec \t spaced \t  out\t\r");
+    TEST_ASSERT_EQUAL_STRING("spaced out", recorded);
+    feed("rec \"\" ''\r"); //Empty quoted arguments
+    TEST_ASSERT_EQUAL_STRING(" ", recorded);
+    feed("rec 1 2 3 4 5 6 7 8 9\r"); //MAX_ARGC counts the command itself
+    TEST_ASSERT_EQUAL_STRING("1 2 3 4 5 6 7", recorded);
+    TEST_ASSERT_NOT_NULL(strstr(out, "Maximum number of arguments"));
+}
+
+void test_script_insert(void)
+{
+    char body[CLI_SCRIPT_LEN];
+
+    cli_machine_mode = true;
+    feed("rec first;insert \"rec in1;rec in2\";rec last\r");
+    TEST_ASSERT_EQUAL_STRING("|first|in1|in2|last", rec_log);
+    //Inserted commands stop the batch like the others
+    rec_log[0] = '\0';
+    feed("insert \"rec in1;fail;rec in2\";rec last\r");
+    TEST_ASSERT_EQUAL_STRING("|in1", rec_log);
+    //Nested: an inserted command inserts again
+    rec_log[0] = '\0';
+    feed("insert \"insert 'rec deep';rec in\";rec last\r");
+    TEST_ASSERT_EQUAL_STRING("|deep|in|last", rec_log);
+    //More than the script buffer takes: refused, nothing of it runs
+    memset(body, 'x', sizeof(body) - 1);
+    body[sizeof(body) - 1] = '\0';
+    memcpy(body, "rec ", 4);
+    rec_log[0] = '\0';
+    clear_output();
+    TEST_ASSERT_FALSE(cli_script_insert(body));
+    feed("insert \"rec a;rec b\"\r");
+    TEST_ASSERT_EQUAL_STRING("|a|b", rec_log);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_yield_resumes_until_done);
+    RUN_TEST(test_any_result_code_finishes);
+    RUN_TEST(test_machine_mode_rc);
+    RUN_TEST(test_machine_mode_record_is_one_line);
+    RUN_TEST(test_machine_mode_string_escapes);
+    RUN_TEST(test_ctrl_c_aborts_a_yielding_command);
+    RUN_TEST(test_ctrl_c_behind_typed_input);
+    RUN_TEST(test_ctrl_c_in_wrapped_part_of_the_fifo);
+    RUN_TEST(test_history_recall);
+    RUN_TEST(test_history_evicts_oldest_whole_entries);
+    RUN_TEST(test_history_search);
+    RUN_TEST(test_batch_split);
+    RUN_TEST(test_batch_stops_at_first_failure);
+    RUN_TEST(test_tokenize);
+    RUN_TEST(test_script_insert);
+    return UNITY_END();
+}
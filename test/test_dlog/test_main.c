@@ -0,0 +1,97 @@
+#include <unity.h>
+
+#define MY_DLOG_ENABLE 1
+#include "my_dlog.h"
+
+/*
+ * What MY_DLOG() stores per argument type. The ring and the frames (my_dlog.c) need the target,
+ * this only captures the words handed to my_dlog_write().
+ */
+
+static uint32_t words[2 * MY_DLOG_MAX_ARGS];
+static uint32_t word_count;
+static uint8_t last_level;
+
+void my_dlog_write(uint8_t level, uint32_t id, const uint32_t* args, uint32_t count)
+{
+    (void)id;
+    last_level = level;
+    word_count = count;
+    for (uint32_t i = 0; i < count; i++) words[i] = args[i];
+}
+
+void setUp(void)
+{
+    word_count = UINT32_MAX;
+}
+void tearDown(void)
+{
+}
+
+void test_no_arguments(void)
+{
+    MY_DLOG(3, "plain");
+    TEST_ASSERT_EQUAL_UINT8(3, last_level);
+    TEST_ASSERT_EQUAL_UINT32(0, word_count);
+}
+
+void test_small_integers_take_a_word(void)
+{
+    int8_t i8 = -3;
+    uint16_t u16 = 60000;
+    int32_t i32 = -5;
+    uint32_t u32 = 0xDEADBEEFu;
+    char c = 'a';
+    _Bool b = 1;
+
+    MY_DLOG(1, "%d %u %ld %lu %c %d", i8, u16, i32, u32, c, b);
+    const uint32_t expected[] = { 0xFFFFFFFDu, 60000u, 0xFFFFFFFBu, 0xDEADBEEFu, 'a', 1 };
+    TEST_ASSERT_EQUAL_UINT32(6, word_count);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(expected, words, 6);
+}
+
+void test_64_bit_integers_take_two_words(void)
+{
+    int64_t i64 = -1234567890123LL;
+    uint64_t u64 = 0x1122334455667788ULL;
+    int after = 9;
+
+    MY_DLOG(1, "%lld %llx %d", i64, u64, after);
+    const uint32_t expected[] = { 0x8E04FB35u, 0xFFFFFEE0u, 0x55667788u, 0x11223344u, 9 };
+    TEST_ASSERT_EQUAL_UINT32(5, word_count);
+    TEST_ASSERT_EQUAL_HEX32_ARRAY(expected, words, 5);
+}
+
+void test_floats_and_pointers(void)
+{
+    float f = 1.5f;
+    double d = 2.5;
+    static const char text[] = "x";
+
+    MY_DLOG(1, "%f %f %s %p", f, d, text, (const void*)text);
+    TEST_ASSERT_EQUAL_UINT32(4, word_count);
+    TEST_ASSERT_EQUAL_HEX32(0x3FC00000u, words[0]);
+    TEST_ASSERT_EQUAL_HEX32(0x40200000u, words[1]); //Doubles go out as float bits
+    TEST_ASSERT_EQUAL_HEX32((uint32_t)(uintptr_t)text, words[2]);
+    TEST_ASSERT_EQUAL_HEX32(words[2], words[3]);
+}
+
+void test_eight_arguments_fit(void)
+{
+    long long big = -1;
+
+    MY_DLOG(1, "%lld %lld %lld %lld %lld %lld %lld %lld", big, big, big, big, big, big, big, big);
+    TEST_ASSERT_EQUAL_UINT32(2 * MY_DLOG_MAX_ARGS, word_count);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFFu, words[2 * MY_DLOG_MAX_ARGS - 1]);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_no_arguments);
+    RUN_TEST(test_small_integers_take_a_word);
+    RUN_TEST(test_64_bit_integers_take_two_words);
+    RUN_TEST(test_floats_and_pointers);
+    RUN_TEST(test_eight_arguments_fit);
+    return UNITY_END();
+}
@@ -0,0 +1,184 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include "my_irq.h"
+
+/*
+ * A synthetic interrupt controller: status latches raised lines until they are acknowledged, and the trap
+ * is taken again as long as anything is latched. Handlers raise events on their own and other lines while
+ * they run, like hardware that keeps going during the trap. Every event raised after its line was last
+ * acknowledged has to be followed by a run of that line's handler.
+ */
+
+#define HANDLED_LINES 8
+
+static my_irq_table_t table;
+static uint32_t status; //Latched lines
+static uint32_t unserviced; //Lines with an event no handler has seen yet
+static uint32_t handled[MY_IRQ_LINE_COUNT];
+static uint32_t entered[MY_IRQ_LINE_COUNT];
+static uint32_t traps;
+static uint32_t raise_budget; //Random events handlers may still raise
+static uint32_t reraise_line;
+static uint32_t reraise_count; //Times reraise_line's handler raises its own line again
+static uint32_t order[16];
+static uint32_t order_len;
+
+static uint32_t rng_state = 0x1B873593u;
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void raise_lines(uint32_t lines)
+{
+    status |= lines;
+    unserviced |= lines & table.registered;
+}
+static void ack(uint32_t lines)
+{
+    status &= ~lines;
+}
+static void enter(uint32_t source)
+{
+    entered[source]++;
+}
+static void service(uint32_t line)
+{
+    handled[line]++;
+    unserviced &= ~(1u << line);
+    if (order_len < 16) order[order_len++] = line;
+    if ((line == reraise_line) && reraise_count)
+    {
+        reraise_count--;
+        raise_lines(1u << line);
+    }
+    //Events that arrive while this handler runs, its own line and unregistered ones included
+    if (raise_budget && (rng() & 1u))
+    {
+        raise_budget--;
+        raise_lines(rng() & rng());
+    }
+}
+#define HANDLER(n) static void handler_##n(void) { service(n); }
+HANDLER(0)
+HANDLER(3)
+HANDLER(4)
+HANDLER(9)
+HANDLER(15)
+HANDLER(16)
+HANDLER(30)
+HANDLER(31)
+static const struct
+{
+    uint32_t line;
+    irq_handler_t handler;
+} handlers[HANDLED_LINES] = { { 0, handler_0 }, { 3, handler_3 }, { 4, handler_4 }, { 9, handler_9 },
+    { 15, handler_15 }, { 16, handler_16 }, { 30, handler_30 }, { 31, handler_31 } };
+
+//The CPU taking the trap for as long as lines stay latched
+static void run_traps(void)
+{
+    for (uint32_t taken = 0; status; taken++)
+    {
+        TEST_ASSERT_LESS_THAN_UINT32(1000, taken);
+        traps++;
+        my_irq_dispatch(&table, status, ack, enter);
+    }
+}
+
+void setUp(void)
+{
+    memset(&table, 0, sizeof(table));
+    for (size_t i = 0; i < HANDLED_LINES; i++)
+    {
+        TEST_ASSERT_TRUE(my_irq_register(&table, handlers[i].line, handlers[i].handler, handlers[i].line));
+    }
+    status = 0;
+    unserviced = 0;
+    traps = 0;
+    raise_budget = 0;
+    reraise_count = 0;
+    order_len = 0;
+    memset(handled, 0, sizeof(handled));
+    memset(entered, 0, sizeof(entered));
+}
+void tearDown(void)
+{
+}
+
+void test_register_checks(void)
+{
+    TEST_ASSERT_FALSE(my_irq_register(&table, MY_IRQ_LINE_COUNT, handler_0, 0));
+    TEST_ASSERT_FALSE(my_irq_register(&table, 5, NULL, 0));
+    TEST_ASSERT_EQUAL_HEX32(0xC0018219u, table.registered);
+}
+
+void test_lowest_line_first(void)
+{
+    raise_lines((1u << 31) | (1u << 4) | (1u << 9));
+    my_irq_dispatch(&table, status, ack, enter);
+    TEST_ASSERT_EQUAL_UINT32(3, order_len);
+    TEST_ASSERT_EQUAL_UINT32(4, order[0]);
+    TEST_ASSERT_EQUAL_UINT32(9, order[1]);
+    TEST_ASSERT_EQUAL_UINT32(31, order[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, entered[9]);
+    TEST_ASSERT_EQUAL_HEX32(0, status);
+}
+
+void test_unregistered_lines_are_spurious(void)
+{
+    raise_lines((1u << 5) | (1u << 20) | (1u << 3));
+    my_irq_dispatch(&table, status, ack, enter);
+    TEST_ASSERT_EQUAL_UINT32(1, table.spurious);
+    TEST_ASSERT_EQUAL_UINT32(1, handled[3]);
+    TEST_ASSERT_EQUAL_HEX32(0, status);
+}
+
+//A handler whose own event comes back while it runs gets called again on the next trap
+void test_own_line_while_servicing(void)
+{
+    raise_lines((1u << 15) | (1u << 16));
+    reraise_line = 15;
+    reraise_count = 2;
+    run_traps();
+    TEST_ASSERT_EQUAL_UINT32(3, traps);
+    TEST_ASSERT_EQUAL_UINT32(3, handled[15]);
+    TEST_ASSERT_EQUAL_UINT32(1, handled[16]);
+    TEST_ASSERT_EQUAL_HEX32(0, unserviced);
+}
+
+//Random masks at trap entry, random events during the handlers: nothing registered is ever dropped
+void test_no_event_lost(void)
+{
+    for (uint32_t round = 0; round < 100000; round++)
+    {
+        raise_lines(rng() & rng());
+        raise_budget = rng() % 8;
+        run_traps();
+        TEST_ASSERT_EQUAL_HEX32(0, unserviced);
+    }
+    uint32_t total = 0;
+    for (size_t i = 0; i < MY_IRQ_LINE_COUNT; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(handled[i], entered[i]);
+        total += handled[i];
+    }
+    TEST_ASSERT_GREATER_THAN(100000, total);
+    TEST_ASSERT_GREATER_THAN(0, table.spurious);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_register_checks);
+    RUN_TEST(test_lowest_line_first);
+    RUN_TEST(test_unregistered_lines_are_spurious);
+    RUN_TEST(test_own_line_while_servicing);
+    RUN_TEST(test_no_event_lost);
+    return UNITY_END();
+}
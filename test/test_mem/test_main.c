@@ -0,0 +1,164 @@
+#include <unity.h>
+
+#include <string.h>
+
+#include <xprintf.h>
+
+#include "my_mem.h"
+
+/*
+ * Arena and pool accounting. Arenas and pools stay registered for the whole program, like on the target,
+ * so each test starts from an init of the same ones.
+ */
+
+static char out[1024];
+static size_t out_len;
+
+MY_ARENA(small, "small", 64);
+MY_ARENA(odd, "odd", 10); //Rounded up to whole words
+MY_POOL(blocks, "blocks", 6, 3); //8-byte blocks
+
+static void capture(int c)
+{
+    if (out_len < sizeof(out) - 1) out[out_len++] = (char)c;
+    out[out_len] = '\0';
+}
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(HAL_OK, my_arena_init(&small));
+    TEST_ASSERT_EQUAL(HAL_OK, my_arena_init(&odd));
+    TEST_ASSERT_EQUAL(HAL_OK, my_pool_init(&blocks));
+    out_len = 0;
+    out[0] = '\0';
+}
+void tearDown(void)
+{
+}
+
+void test_allocations_are_word_aligned_and_packed(void)
+{
+    uint8_t* a = my_arena_alloc(&small, 1);
+    uint8_t* b = my_arena_alloc(&small, 5);
+    uint8_t* c = my_arena_alloc(&small, 4);
+
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)a % 4);
+    TEST_ASSERT_EQUAL_PTR(a + 4, b);
+    TEST_ASSERT_EQUAL_PTR(b + 8, c);
+    TEST_ASSERT_EQUAL_size_t(16, small.used);
+    TEST_ASSERT_EQUAL_size_t(12, odd.size);
+}
+
+void test_exhaustion_fails_and_counts(void)
+{
+    uint32_t failures = small.failures;
+
+    TEST_ASSERT_NOT_NULL(my_arena_alloc(&small, 60));
+    TEST_ASSERT_NULL(my_arena_alloc(&small, 8));
+    TEST_ASSERT_NOT_NULL(my_arena_alloc(&small, 4)); //A failed request doesn't use up what is left
+    TEST_ASSERT_NULL(my_arena_alloc(&small, 1));
+    TEST_ASSERT_EQUAL_UINT32(failures + 2, small.failures);
+    TEST_ASSERT_EQUAL_size_t(64, small.used);
+}
+
+//Initializing again (the owner re-initialized) releases everything but doesn't register a second time
+void test_init_again_releases(void)
+{
+    void* first = my_arena_alloc(&small, 40);
+
+    TEST_ASSERT_EQUAL(HAL_OK, my_arena_init(&small));
+    TEST_ASSERT_EQUAL_size_t(0, small.used);
+    TEST_ASSERT_EQUAL_size_t(64, small.high_water);
+    TEST_ASSERT_EQUAL_PTR(first, my_arena_alloc(&small, 4));
+
+    xdev_out(capture);
+    my_mem_report();
+    xdev_out(NULL);
+    const char* line = strstr(out, "\nsmall\t");
+    TEST_ASSERT_NOT_NULL(line);
+    TEST_ASSERT_NULL(strstr(line + 1, "\nsmall\t"));
+}
+
+void test_registry_is_bounded(void)
+{
+    static my_arena_t extra[MY_MEM_MAX_ARENAS];
+    size_t accepted = 0;
+
+    for (size_t i = 0; i < MY_MEM_MAX_ARENAS; i++)
+    {
+        extra[i] = (my_arena_t){ .name = "extra" };
+        accepted += (my_arena_init(&(extra[i])) == HAL_OK);
+    }
+    TEST_ASSERT_EQUAL_size_t(MY_MEM_MAX_ARENAS - 2, accepted);
+}
+
+void test_pool_blocks_are_distinct_and_reused(void)
+{
+    uint8_t* a = my_pool_alloc(&blocks);
+    uint8_t* b = my_pool_alloc(&blocks);
+
+    TEST_ASSERT_EQUAL_size_t(8, blocks.block_size);
+    TEST_ASSERT_EQUAL_PTR(blocks.storage, a); //Lowest block first out
+    TEST_ASSERT_EQUAL_PTR(a + 8, b);
+    memset(a, 0xAA, 8);
+    memset(b, 0x55, 8);
+    TEST_ASSERT_EQUAL(HAL_OK, my_pool_free(&blocks, a));
+    TEST_ASSERT_EQUAL_PTR(a, my_pool_alloc(&blocks)); //Last freed, first out
+    TEST_ASSERT_EQUAL_size_t(2, blocks.used);
+}
+
+void test_pool_exhaustion_fails_and_counts(void)
+{
+    uint32_t failures = blocks.failures;
+    void* taken[3];
+
+    for (size_t i = 0; i < 3; i++) TEST_ASSERT_NOT_NULL(taken[i] = my_pool_alloc(&blocks));
+    TEST_ASSERT_NULL(my_pool_alloc(&blocks));
+    TEST_ASSERT_EQUAL_UINT32(failures + 1, blocks.failures);
+    TEST_ASSERT_EQUAL_size_t(3, blocks.high_water);
+    TEST_ASSERT_EQUAL(HAL_OK, my_pool_free(&blocks, taken[1]));
+    TEST_ASSERT_EQUAL_PTR(taken[1], my_pool_alloc(&blocks));
+}
+
+void test_pool_free_rejects_foreign_pointers(void)
+{
+    uint32_t outside;
+    uint8_t* a = my_pool_alloc(&blocks);
+
+    TEST_ASSERT_EQUAL(HAL_ERROR, my_pool_free(&blocks, &outside));
+    TEST_ASSERT_EQUAL(HAL_ERROR, my_pool_free(&blocks, a + 4)); //Inside a block
+    TEST_ASSERT_EQUAL(HAL_ERROR, my_pool_free(&blocks, blocks.storage + 3 * 8)); //Just past the end
+    TEST_ASSERT_EQUAL(HAL_OK, my_pool_free(&blocks, a));
+    TEST_ASSERT_EQUAL(HAL_ERROR, my_pool_free(&blocks, a)); //Nothing handed out any more
+    TEST_ASSERT_EQUAL_size_t(0, blocks.used);
+}
+
+void test_report_lists_pools(void)
+{
+    TEST_ASSERT_EQUAL(HAL_OK, my_pool_init(&blocks)); //Already registered, only refilled
+    TEST_ASSERT_NOT_NULL(my_pool_alloc(&blocks));
+
+    xdev_out(capture);
+    my_mem_report();
+    xdev_out(NULL);
+    const char* line = strstr(out, "\nblocks\t8\t3\t1\t");
+    TEST_ASSERT_NOT_NULL(line);
+    TEST_ASSERT_NULL(strstr(line + 1, "\nblocks\t"));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_allocations_are_word_aligned_and_packed);
+    RUN_TEST(test_exhaustion_fails_and_counts);
+    RUN_TEST(test_init_again_releases);
+    RUN_TEST(test_registry_is_bounded);
+    RUN_TEST(test_pool_blocks_are_distinct_and_reused);
+    RUN_TEST(test_pool_exhaustion_fails_and_counts);
+    RUN_TEST(test_pool_free_rejects_foreign_pointers);
+    RUN_TEST(test_report_lists_pools);
+    return UNITY_END();
+}
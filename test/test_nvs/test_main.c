@@ -0,0 +1,161 @@
+#include <unity.h>
+
+#include <stddef.h>
+
+#include "nvs.h"
+#include "host_eeprom.h"
+
+/*
+ * Dirty-page saving on the fake EEPROM (src/host/host_eeprom.c): what a save erases and programs, in which
+ * order, and what a load finds after the power was cut anywhere in a save.
+ */
+
+//nvs.c's layout: 128-byte pages from page 32, the version page first, then the storage pages
+#define PAGE_BYTES 128u
+#define VERSION_ADDR (32u * PAGE_BYTES)
+#define STORAGE_ADDR(page) ((33u + (page)) * PAGE_BYTES)
+#define PAGE_OF(member) (offsetof(nvs_storage_t, member) / PAGE_BYTES)
+
+static nvs_storage_t* nvs;
+
+static size_t save_and_log(const host_eeprom_op_t** ops)
+{
+    host_eeprom_clear_log();
+    TEST_ASSERT_EQUAL(HAL_OK, my_nvs_save());
+    return host_eeprom_get_log(ops);
+}
+
+void setUp(void)
+{
+    host_eeprom_blank();
+    TEST_ASSERT_NOT_EQUAL(HAL_OK, my_nvs_initialize(&nvs)); //Blank: defaults
+    TEST_ASSERT_NOT_NULL(nvs);
+}
+void tearDown(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(0, host_eeprom_get_faults()); //Never programmed over data without an erase
+}
+
+//The fields the tests change have to sit on different pages for the ordering to mean anything
+void test_layout(void)
+{
+    TEST_ASSERT_EQUAL_size_t(0, PAGE_OF(tunings_0.kP));
+    TEST_ASSERT_GREATER_THAN(0, PAGE_OF(crc32));
+    TEST_ASSERT_EQUAL_size_t(PAGE_OF(crc32), PAGE_OF(coproc_gpio_out_invert));
+}
+
+void test_first_save_writes_version_first(void)
+{
+    const host_eeprom_op_t* ops;
+    my_nvs_save_stats_t stats;
+
+    size_t count = save_and_log(&ops);
+    my_nvs_get_save_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(stats.pages_total, stats.pages_written);
+    TEST_ASSERT_EQUAL_size_t(2 * stats.pages_total, count);
+    TEST_ASSERT_TRUE(ops[0].erase);
+    TEST_ASSERT_EQUAL_HEX32(VERSION_ADDR, ops[0].address);
+    TEST_ASSERT_FALSE(ops[1].erase);
+    TEST_ASSERT_EQUAL_HEX32(VERSION_ADDR, ops[1].address);
+    TEST_ASSERT_EQUAL_HEX32(STORAGE_ADDR(PAGE_OF(crc32)), ops[count - 1].address);
+    TEST_ASSERT_EQUAL(HAL_OK, my_nvs_load());
+}
+
+void test_unchanged_save_touches_nothing(void)
+{
+    const host_eeprom_op_t* ops;
+    my_nvs_save_stats_t stats;
+
+    save_and_log(&ops);
+    TEST_ASSERT_EQUAL_size_t(0, save_and_log(&ops));
+    TEST_ASSERT_EQUAL(HAL_OK, my_nvs_load());
+    TEST_ASSERT_EQUAL_size_t(0, save_and_log(&ops));
+    my_nvs_get_save_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pages_written);
+}
+
+//Only the changed page and the CRC page are rewritten, the CRC page last
+void test_changed_page_then_crc_page(void)
+{
+    const host_eeprom_op_t* ops;
+
+    save_and_log(&ops);
+    nvs->tunings_0.kP += 1.0f;
+    TEST_ASSERT_EQUAL_size_t(4, save_and_log(&ops));
+    TEST_ASSERT_TRUE(ops[0].erase);
+    TEST_ASSERT_EQUAL_HEX32(STORAGE_ADDR(PAGE_OF(tunings_0.kP)), ops[0].address);
+    TEST_ASSERT_EQUAL_HEX32(STORAGE_ADDR(PAGE_OF(tunings_0.kP)), ops[1].address);
+    TEST_ASSERT_TRUE(ops[2].erase);
+    TEST_ASSERT_EQUAL_HEX32(STORAGE_ADDR(PAGE_OF(crc32)), ops[2].address);
+    TEST_ASSERT_FALSE(ops[3].erase);
+    TEST_ASSERT_EQUAL_HEX32(STORAGE_ADDR(PAGE_OF(crc32)), ops[3].address);
+
+    nvs->coproc_gpio_out_invert ^= 1u; //Same page as the CRC: that page alone
+    TEST_ASSERT_EQUAL_size_t(2, save_and_log(&ops));
+    TEST_ASSERT_EQUAL_HEX32(STORAGE_ADDR(PAGE_OF(crc32)), ops[1].address);
+}
+
+//Power cut on every operation of a two-page save: a load finds the old settings, the new ones or a CRC error
+void test_interrupted_save_never_loads_a_mix(void)
+{
+    const host_eeprom_op_t* ops;
+    const float old_kp = 1.0f;
+    const float new_kp = 2.0f;
+    uint32_t cuts = 0;
+
+    for (uint32_t op = 1; ; op++)
+    {
+        nvs->tunings_0.kP = old_kp;
+        nvs->coproc_gpio_out_invert = 0;
+        save_and_log(&ops);
+        nvs->tunings_0.kP = new_kp;
+        nvs->coproc_gpio_out_invert = 1;
+        host_eeprom_fail_after(op);
+        HAL_StatusTypeDef saved = my_nvs_save();
+        host_eeprom_fail_after(0);
+        if (saved == HAL_OK) break;
+        cuts++;
+
+        HAL_StatusTypeDef loaded = my_nvs_load();
+        if (loaded == HAL_OK)
+        {
+            bool old = (nvs->tunings_0.kP == old_kp) && (nvs->coproc_gpio_out_invert == 0);
+            bool new = (nvs->tunings_0.kP == new_kp) && (nvs->coproc_gpio_out_invert == 1);
+            TEST_ASSERT_TRUE_MESSAGE(old || new, "old and new settings mixed");
+        }
+        else TEST_ASSERT_EQUAL(MY_NVS_ERR_CRC_FAILED, loaded);
+
+        //The next save after a failed one rewrites everything and sticks
+        nvs->tunings_0.kP = new_kp;
+        nvs->coproc_gpio_out_invert = 1;
+        TEST_ASSERT_EQUAL(HAL_OK, my_nvs_save());
+        nvs->tunings_0.kP = 0.0f;
+        TEST_ASSERT_EQUAL(HAL_OK, my_nvs_load());
+        TEST_ASSERT_EQUAL_FLOAT(new_kp, nvs->tunings_0.kP);
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, cuts);
+}
+
+void test_reset_writes_version_again(void)
+{
+    const host_eeprom_op_t* ops;
+
+    save_and_log(&ops);
+    TEST_ASSERT_EQUAL(HAL_OK, my_nvs_reset());
+    TEST_ASSERT_NOT_EQUAL(HAL_OK, my_nvs_load());
+    save_and_log(&ops);
+    TEST_ASSERT_EQUAL_HEX32(VERSION_ADDR, ops[0].address);
+    TEST_ASSERT_EQUAL(HAL_OK, my_nvs_load());
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_layout);
+    RUN_TEST(test_first_save_writes_version_first);
+    RUN_TEST(test_unchanged_save_touches_nothing);
+    RUN_TEST(test_changed_page_then_crc_page);
+    RUN_TEST(test_interrupted_save_never_loads_a_mix);
+    RUN_TEST(test_reset_writes_version_again);
+    return UNITY_END();
+}
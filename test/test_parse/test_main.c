@@ -0,0 +1,265 @@
+#include <unity.h>
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "my_parse.h"
+
+/*
+ * my_parse against the C library: strtof() for floats, exact integer math for Q values
+ */
+
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+static float parse_float_ok(const char* s)
+{
+    float f = 0.0f;
+    my_parse_err_t err = my_parse_float(s, &f);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(MY_PARSE_OK, err, s);
+    return f;
+}
+static void assert_same_float(const char* s)
+{
+    float expected = strtof(s, NULL);
+    float got = parse_float_ok(s);
+    if (memcmp(&expected, &got, sizeof(float)) != 0)
+    {
+        char msg[96];
+        snprintf(msg, sizeof(msg), "%s: %.9g instead of %.9g", s, got, expected);
+        TEST_FAIL_MESSAGE(msg);
+    }
+}
+
+void setUp(void)
+{
+}
+void tearDown(void)
+{
+}
+
+void test_integers(void)
+{
+    uint32_t u;
+    int32_t i;
+
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_u32("4294967295", &u));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, u);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_u32("4294967296", &u));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_u32("0xDEADbeef", &u));
+    TEST_ASSERT_EQUAL_UINT32(0xDEADBEEF, u);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_u32("0b1011", &u));
+    TEST_ASSERT_EQUAL_UINT32(11, u);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_SYNTAX, my_parse_u32("0b102", &u));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_SYNTAX, my_parse_u32("99999999999x", &u)); //Syntax before range
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_SYNTAX, my_parse_u32("0x", &u));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_SYNTAX, my_parse_u32(" 1", &u));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_EMPTY, my_parse_u32("", &u));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_i32("-2147483648", &i));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, i);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_i32("2147483648", &i));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_i32("-0x10", &i));
+    TEST_ASSERT_EQUAL_INT32(-16, i);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_hex("ff", &u));
+    TEST_ASSERT_EQUAL_UINT32(255, u);
+}
+
+void test_float_limits(void)
+{
+    float f;
+
+    TEST_ASSERT_EQUAL_FLOAT(FLT_MAX, parse_float_ok("3.4028235e38"));
+    TEST_ASSERT_EQUAL_FLOAT(FLT_MAX, parse_float_ok("340282346638528859811704183484516925440"));
+    TEST_ASSERT_EQUAL_FLOAT(-FLT_MAX, parse_float_ok("-3.40282347e+38"));
+    TEST_ASSERT_EQUAL_FLOAT(FLT_MIN, parse_float_ok("1.17549435e-38"));
+    TEST_ASSERT_EQUAL_FLOAT(FLT_MIN, parse_float_ok("0.0000000000000000000000000000000000000117549435"));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_float("3.4028236e38", &f)); //Rounds to infinity
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_float("1e39", &f));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_float("1.1754942e-38", &f)); //Denormal
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_float("1e-300", &f));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_float("1e999999", &f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, parse_float_ok("0e999999"));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, parse_float_ok("-0.000"));
+}
+
+void test_float_syntax(void)
+{
+    static const char* const bad[] = { "1e", "1e+", ".", "-", "1.2.3", "inf", "nan", "1 ", " 1", "0x10", "1f" };
+    float f;
+
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    {
+        TEST_ASSERT_EQUAL_INT_MESSAGE(MY_PARSE_SYNTAX, my_parse_float(bad[i], &f), bad[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_EMPTY, my_parse_float("", &f));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, parse_float_ok(".5"));
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, parse_float_ok("5."));
+    TEST_ASSERT_EQUAL_FLOAT(-1250.0f, parse_float_ok("-1.25E+3"));
+}
+
+void test_float_known_cases(void)
+{
+    static const char* const cases[] = {
+        "3.68991822e-25", //Was 3 ULPs off
+        "0.1", "0.3", "1.1", "3.14159265", "16777217", "16777219", "33554435", "8388608.5", "8388609.5",
+        "1.00000005960464477539062", "1.000000059604644775390625",
+        "9.99999999999999999999999", "123456789012345678901234567890", "0.000000000000000000000000000000000001",
+        "2.3509885615147285834557659820715330266457179855179808553659262368500061299303460771170648513361811637878"
+        "4179687e-38"
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) assert_same_float(cases[i]);
+}
+
+//Within ~2^-51 of a halfway point the double scaling may round the wrong way: 1 ULP at most
+void test_float_near_halfway(void)
+{
+    static const char* const cases[] = {
+        "7.038531e-26", "4.30373586e-15",
+        "1.0000000596046447753906251" //Just above halfway, but only in the 27th digit
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        float expected = strtof(cases[i], NULL);
+        float got = parse_float_ok(cases[i]);
+        TEST_ASSERT_TRUE_MESSAGE((got == expected) || (got == nextafterf(expected, 0.0f)) ||
+            (got == nextafterf(expected, INFINITY)), cases[i]);
+    }
+}
+
+//Every float printed with 9 and with 17 significant digits comes back as itself
+void test_float_round_trip(void)
+{
+    char s[48];
+
+    for (int i = 0; i < 300000; i++)
+    {
+        uint32_t bits = rng();
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        if (!isnormal(f)) continue;
+        snprintf(s, sizeof(s), (i & 1) ? "%.9g" : "%.17g", f);
+        float got = parse_float_ok(s);
+        if (memcmp(&got, &f, sizeof(f)) != 0) TEST_FAIL_MESSAGE(s);
+    }
+}
+
+//Random decimal strings, the kind typed at the console and the kind no float matches exactly
+void test_float_random_decimals(void)
+{
+    char s[64];
+
+    for (int i = 0; i < 300000; i++)
+    {
+        uint32_t digits = 1 + rng() % 19;
+        uint32_t point = rng() % (digits + 1);
+        size_t len = 0;
+        if (rng() & 1) s[len++] = '-';
+        for (uint32_t d = 0; d < digits; d++)
+        {
+            if (d == point) s[len++] = '.';
+            s[len++] = (char)('0' + rng() % 10);
+        }
+        if (rng() & 1) len += snprintf(&s[len], sizeof(s) - len, "e%d", (int)(rng() % 80) - 40);
+        s[len] = '\0';
+        float expected = strtof(s, NULL);
+        if ((fabsf(expected) < FLT_MIN) || isinf(expected)) continue; //Out of range, covered above
+        assert_same_float(s);
+    }
+}
+
+void test_q(void)
+{
+    int32_t q;
+
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_q("1.5", 16, &q));
+    TEST_ASSERT_EQUAL_INT32(0x18000, q);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_q("-0.25", 1, &q)); //Half a unit: away from zero
+    TEST_ASSERT_EQUAL_INT32(-1, q);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_q("0.2499999999", 1, &q));
+    TEST_ASSERT_EQUAL_INT32(0, q);
+    //2^-32, half a unit of Q31: digits past the 9th decide it
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_q("0.00000000023283064365386962890625", 31, &q));
+    TEST_ASSERT_EQUAL_INT32(1, q);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_q("0.00000000023283064365386962890624999", 31, &q));
+    TEST_ASSERT_EQUAL_INT32(0, q);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_q("0.00000000069849193096160888671875", 31, &q)); //1.5 units
+    TEST_ASSERT_EQUAL_INT32(2, q);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_q("0.00000000069849193096160888671874", 31, &q));
+    TEST_ASSERT_EQUAL_INT32(1, q);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_q("0.99999999999999999999999999", 16, &q));
+    TEST_ASSERT_EQUAL_INT32(0x10000, q);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_q("-1", 31, &q));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, q);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_q("1", 31, &q));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_q("0.99999999999", 31, &q)); //Rounds up to 1.0
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_OK, my_parse_q("32767.99998", 16, &q));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, q);
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_q("32767.999993", 16, &q)); //Rounds up to 2^31
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_RANGE, my_parse_q("1", 32, &q));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_SYNTAX, my_parse_q("1.2e3", 8, &q));
+    TEST_ASSERT_EQUAL_INT(MY_PARSE_SYNTAX, my_parse_q("0.1234567890123456789012345678901234567890x", 8, &q));
+}
+
+#ifdef __SIZEOF_INT128__
+//Exact reference: round(value * 2^frac_bits), ties away from zero, for up to 18 fraction digits
+void test_q_random(void)
+{
+    char s[48];
+
+    for (int i = 0; i < 200000; i++)
+    {
+        uint32_t frac_bits = rng() % 32;
+        uint32_t integer = rng() % 4;
+        uint32_t digits = 1 + rng() % 18;
+        unsigned __int128 fraction = 0;
+        unsigned __int128 scale = 1;
+        size_t len = snprintf(s, sizeof(s), "%u.", (unsigned)integer);
+        for (uint32_t d = 0; d < digits; d++)
+        {
+            uint32_t digit = rng() % 10;
+            s[len++] = (char)('0' + digit);
+            fraction = fraction * 10 + digit;
+            scale *= 10;
+        }
+        s[len] = '\0';
+        unsigned __int128 expected = ((unsigned __int128)integer << frac_bits) +
+            (((fraction << (frac_bits + 1)) / scale + 1) >> 1);
+        int32_t q;
+        my_parse_err_t err = my_parse_q(s, (uint8_t)frac_bits, &q);
+        if (expected > INT32_MAX)
+        {
+            TEST_ASSERT_EQUAL_INT_MESSAGE(MY_PARSE_RANGE, err, s);
+            continue;
+        }
+        TEST_ASSERT_EQUAL_INT_MESSAGE(MY_PARSE_OK, err, s);
+        TEST_ASSERT_EQUAL_INT32_MESSAGE((int32_t)expected, q, s);
+    }
+}
+#endif
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_integers);
+    RUN_TEST(test_float_limits);
+    RUN_TEST(test_float_syntax);
+    RUN_TEST(test_float_known_cases);
+    RUN_TEST(test_float_near_halfway);
+    RUN_TEST(test_float_round_trip);
+    RUN_TEST(test_float_random_decimals);
+    RUN_TEST(test_q);
+#ifdef __SIZEOF_INT128__
+    RUN_TEST(test_q_random);
+#endif
+    return UNITY_END();
+}
@@ -0,0 +1,96 @@
+#include <unity.h>
+
+#include "my_sched.h"
+#include "host_clock.h"
+
+/*
+ * Adding and running tasks on the fake clock. A rejected add must leave the task exactly as it was.
+ */
+
+static uint32_t calls[4];
+
+static void count(void* ctx)
+{
+    calls[(uintptr_t)ctx]++;
+}
+static void run_until(uint32_t us)
+{
+    while ((int32_t)(get_micros_32() - us) < 0)
+    {
+        host_clock_advance(100);
+        my_sched_run();
+    }
+}
+
+void setUp(void)
+{
+    host_clock_set(1000);
+    my_sched_init();
+    for (size_t i = 0; i < 4; i++) calls[i] = 0;
+}
+void tearDown(void)
+{
+}
+
+void test_periodic_and_oneshot(void)
+{
+    my_sched_task_t periodic = MY_SCHED_TASK("periodic", count, 1000);
+    my_sched_task_t oneshot = MY_SCHED_TASK("oneshot", count, 0);
+    oneshot.ctx = (void*)1;
+
+    TEST_ASSERT_TRUE(my_sched_add_periodic(&periodic));
+    TEST_ASSERT_TRUE(my_sched_add_oneshot(&oneshot, 2500));
+    run_until(11000);
+    TEST_ASSERT_EQUAL_UINT32(10, calls[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, calls[1]);
+    TEST_ASSERT_EQUAL_size_t(1, my_sched_get_task_count());
+}
+
+//Adding a queued task again fails and changes nothing: a periodic task doesn't turn one-shot
+void test_add_queued_task_is_rejected_unchanged(void)
+{
+    my_sched_task_t task = MY_SCHED_TASK("task", count, 1000);
+
+    TEST_ASSERT_TRUE(my_sched_add_periodic(&task));
+    host_clock_advance(1500);
+    my_sched_run();
+    my_sched_task_t before = task;
+
+    TEST_ASSERT_FALSE(my_sched_add_oneshot(&task, 50000));
+    TEST_ASSERT_FALSE(my_sched_add_periodic(&task));
+    TEST_ASSERT_TRUE(task.periodic);
+    TEST_ASSERT_EQUAL_UINT32(before.timer.interval, task.timer.interval);
+    TEST_ASSERT_EQUAL_UINT32(before.timer.last_time, task.timer.last_time);
+    TEST_ASSERT_EQUAL_UINT32(before.min_period, task.min_period);
+    TEST_ASSERT_EQUAL_UINT32(before.deadline, task.deadline);
+
+    run_until(get_micros_32() + 10000);
+    TEST_ASSERT_EQUAL_UINT32(11, calls[0]);
+    TEST_ASSERT_EQUAL_size_t(1, my_sched_get_task_count());
+}
+
+void test_full_queue_is_rejected_unchanged(void)
+{
+    static my_sched_task_t tasks[MY_SCHED_MAX_TASKS];
+    my_sched_task_t extra = MY_SCHED_TASK("extra", count, 700);
+
+    for (size_t i = 0; i < MY_SCHED_MAX_TASKS; i++)
+    {
+        tasks[i] = (my_sched_task_t)MY_SCHED_TASK("task", count, 1000);
+        TEST_ASSERT_TRUE(my_sched_add_periodic(&(tasks[i])));
+    }
+    TEST_ASSERT_FALSE(my_sched_add_oneshot(&extra, 5));
+    TEST_ASSERT_FALSE(extra.periodic);
+    TEST_ASSERT_EQUAL_UINT32(700, extra.timer.interval);
+    TEST_ASSERT_EQUAL_UINT32(0, extra.timer.last_time);
+    TEST_ASSERT_EQUAL_UINT16(MY_SCHED_NOT_QUEUED, extra.heap_index);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_periodic_and_oneshot);
+    RUN_TEST(test_add_queued_task_is_rejected_unchanged);
+    RUN_TEST(test_full_queue_is_rejected_unchanged);
+    return UNITY_END();
+}
@@ -0,0 +1,168 @@
+#include <unity.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "my_spsc.h"
+
+MY_SPSC_DEFINE(ring, uint8_t, 8)
+MY_SPSC_DEFINE(word_ring, uint32_t, 64)
+
+static ring_t q;
+
+void setUp(void)
+{
+    ring_init(&q);
+}
+void tearDown(void)
+{
+}
+
+void test_push_pop_in_order(void)
+{
+    uint8_t value = 0;
+
+    TEST_ASSERT_FALSE(ring_pop(&q, &value));
+    for (uint8_t i = 0; i < 8; i++) TEST_ASSERT_TRUE(ring_push(&q, i));
+    TEST_ASSERT_EQUAL_UINT32(8, ring_count(&q));
+    TEST_ASSERT_EQUAL_UINT32(0, ring_free(&q));
+    TEST_ASSERT_FALSE(ring_push(&q, 8)); //All of the capacity is usable, and no more
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        TEST_ASSERT_TRUE(ring_pop(&q, &value));
+        TEST_ASSERT_EQUAL_UINT8(i, value);
+    }
+    TEST_ASSERT_FALSE(ring_pop(&q, &value));
+    TEST_ASSERT_EQUAL_UINT32(8, ring_free(&q));
+}
+
+void test_bulk_across_the_wrap(void)
+{
+    const uint8_t src[] = { 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 };
+    uint8_t dst[10] = { 0 };
+    uint8_t value = 0;
+
+    for (uint8_t i = 0; i < 5; i++) ring_push(&q, i);
+    for (uint8_t i = 0; i < 5; i++) ring_pop(&q, &value);
+    TEST_ASSERT_EQUAL_size_t(8, ring_push_n(&q, src, sizeof(src))); //Clipped to the free space, wraps after 3
+    TEST_ASSERT_EQUAL_size_t(0, ring_push_n(&q, src, 1));
+    TEST_ASSERT_EQUAL_size_t(8, ring_pop_n(&q, dst, sizeof(dst)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(src, dst, 8);
+    TEST_ASSERT_EQUAL_size_t(0, ring_pop_n(&q, dst, sizeof(dst)));
+}
+
+void test_peek_stops_at_the_wrap(void)
+{
+    const uint8_t src[] = { 1, 2, 3, 4, 5, 6 };
+    uint8_t* span;
+    uint8_t value = 0;
+
+    for (uint8_t i = 0; i < 6; i++) ring_push(&q, i);
+    for (uint8_t i = 0; i < 6; i++) ring_pop(&q, &value);
+    ring_push_n(&q, src, sizeof(src));
+    TEST_ASSERT_EQUAL_size_t(2, ring_peek(&q, &span));
+    TEST_ASSERT_EQUAL_UINT8(1, span[0]);
+    TEST_ASSERT_EQUAL_UINT8(2, span[1]);
+    ring_consume(&q, 2);
+    TEST_ASSERT_EQUAL_size_t(4, ring_peek(&q, &span));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(&(src[2]), span, 4);
+    ring_consume(&q, 4);
+    TEST_ASSERT_EQUAL_size_t(0, ring_peek(&q, &span));
+    TEST_ASSERT_EQUAL_UINT32(0, ring_count(&q));
+}
+
+void test_free_running_indices_wrap(void)
+{
+    uint8_t dst[8];
+
+    q.head = q.tail = UINT32_MAX - 2; //Both indices overflow in the middle of the transfer
+    TEST_ASSERT_EQUAL_size_t(8, ring_push_n(&q, (const uint8_t*)"abcdefgh", 8));
+    TEST_ASSERT_EQUAL_UINT32(8, ring_count(&q));
+    TEST_ASSERT_FALSE(ring_push(&q, 'x'));
+    TEST_ASSERT_EQUAL_size_t(8, ring_pop_n(&q, dst, sizeof(dst)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("abcdefgh", dst, 8);
+    TEST_ASSERT_EQUAL_UINT32(8, ring_free(&q));
+}
+
+/*
+ * Producer and consumer on two threads, a mix of single and bulk operations on both sides;
+ * the consumer has to see every value once and in order. Either side yields when it can't make progress,
+ * so the test doesn't crawl on a single core
+ */
+#define STRESS_VALUES 2000000u
+
+static word_ring_t stress_ring;
+
+static void* stress_producer(void* arg)
+{
+    (void)arg;
+    uint32_t next = 0;
+    while (next < STRESS_VALUES)
+    {
+        if (next & 1u)
+        {
+            if (word_ring_push(&stress_ring, next)) next++;
+            else sched_yield();
+        }
+        else
+        {
+            uint32_t chunk[7];
+            size_t n = 0;
+            for (; (n < 7) && ((next + n) < STRESS_VALUES); n++) chunk[n] = next + n;
+            size_t pushed = word_ring_push_n(&stress_ring, chunk, n);
+            if (!pushed) sched_yield();
+            next += pushed;
+        }
+    }
+    return NULL;
+}
+
+void test_two_threads_lose_nothing(void)
+{
+    pthread_t producer;
+    uint32_t expected = 0;
+    uint32_t mismatches = 0;
+
+    word_ring_init(&stress_ring);
+    TEST_ASSERT_EQUAL_INT(0, pthread_create(&producer, NULL, stress_producer, NULL));
+    while (expected < STRESS_VALUES)
+    {
+        uint32_t* span;
+        uint32_t chunk[5];
+        size_t n = 0;
+        switch (expected % 3)
+        {
+        case 0:
+            if (word_ring_pop(&stress_ring, chunk))
+            {
+                mismatches += (chunk[0] != expected++);
+                n = 1;
+            }
+            break;
+        case 1:
+            n = word_ring_pop_n(&stress_ring, chunk, 5);
+            for (size_t i = 0; i < n; i++) mismatches += (chunk[i] != expected++);
+            break;
+        default:
+            n = word_ring_peek(&stress_ring, &span);
+            for (size_t i = 0; i < n; i++) mismatches += (span[i] != expected++);
+            word_ring_consume(&stress_ring, n);
+            break;
+        }
+        if (!n) sched_yield();
+    }
+    pthread_join(producer, NULL);
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+    TEST_ASSERT_EQUAL_UINT32(0, word_ring_count(&stress_ring));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_push_pop_in_order);
+    RUN_TEST(test_bulk_across_the_wrap);
+    RUN_TEST(test_peek_stops_at_the_wrap);
+    RUN_TEST(test_free_running_indices_wrap);
+    RUN_TEST(test_two_threads_lose_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,169 @@
+#include <unity.h>
+
+#include "my_twheel.h"
+#include "host_clock.h"
+
+#define TICK MY_TWHEEL_TICK_US
+
+typedef struct
+{
+    my_twheel_timer_t timer;
+    uint32_t deadline; //us, armed at + timeout
+    uint32_t fired_at;
+    uint32_t fired;
+} probe_t;
+
+static void probe_fire(my_twheel_timer_t* timer, void* ctx)
+{
+    (void)timer;
+    probe_t* probe = ctx;
+    probe->fired_at = get_micros_32();
+    probe->fired++;
+}
+static void probe_arm(probe_t* probe, uint32_t timeout_us)
+{
+    probe->deadline = get_micros_32() + timeout_us;
+    probe->fired = 0;
+    my_twheel_arm(&(probe->timer), timeout_us);
+}
+//The main loop calling my_twheel_tick() every step_us
+static void run_for(uint32_t us, uint32_t step_us)
+{
+    for (uint32_t t = 0; t < us; t += step_us)
+    {
+        host_clock_advance(step_us);
+        my_twheel_tick();
+    }
+}
+
+static uint32_t rng_state = 0x2545F491u;
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+void setUp(void)
+{
+    host_clock_set(123456);
+    my_twheel_init();
+}
+void tearDown(void)
+{
+}
+
+void test_fires_once_on_time(void)
+{
+    probe_t probe;
+
+    my_twheel_setup(&(probe.timer), probe_fire, &probe);
+    probe_arm(&probe, 5 * TICK);
+    TEST_ASSERT_TRUE(my_twheel_is_armed(&(probe.timer)));
+    TEST_ASSERT_EQUAL_UINT32(1, my_twheel_get_pending());
+    run_for(20 * TICK, 10);
+    TEST_ASSERT_EQUAL_UINT32(1, probe.fired);
+    TEST_ASSERT_FALSE(my_twheel_is_armed(&(probe.timer)));
+    TEST_ASSERT_EQUAL_UINT32(0, my_twheel_get_pending());
+    TEST_ASSERT_EQUAL_UINT32(probe.deadline, probe.fired_at);
+}
+
+//my_twheel_tick() hasn't run for several ticks when the timer is armed: that time is already gone
+void test_unprocessed_ticks_count(void)
+{
+    probe_t probe;
+
+    my_twheel_setup(&(probe.timer), probe_fire, &probe);
+    host_clock_advance(5 * TICK + TICK / 2);
+    probe_arm(&probe, 2 * TICK);
+    run_for(10 * TICK, 10);
+    TEST_ASSERT_EQUAL_UINT32(1, probe.fired);
+    TEST_ASSERT_GREATER_OR_EQUAL_INT32(0, (int32_t)(probe.fired_at - probe.deadline));
+    TEST_ASSERT_LESS_THAN_INT32(TICK, (int32_t)(probe.fired_at - probe.deadline));
+}
+
+void test_cancel_and_rearm(void)
+{
+    probe_t probe;
+
+    my_twheel_setup(&(probe.timer), probe_fire, &probe);
+    probe_arm(&probe, 3 * TICK);
+    TEST_ASSERT_TRUE(my_twheel_cancel(&(probe.timer)));
+    TEST_ASSERT_FALSE(my_twheel_cancel(&(probe.timer)));
+    run_for(5 * TICK, TICK);
+    TEST_ASSERT_EQUAL_UINT32(0, probe.fired);
+
+    probe_arm(&probe, 3 * TICK);
+    run_for(TICK, TICK);
+    probe_arm(&probe, 4 * TICK); //Re-arming moves the timer instead of adding a second one
+    TEST_ASSERT_EQUAL_UINT32(1, my_twheel_get_pending());
+    run_for(10 * TICK, TICK);
+    TEST_ASSERT_EQUAL_UINT32(1, probe.fired);
+    TEST_ASSERT_EQUAL_UINT32(probe.deadline, probe.fired_at);
+}
+
+//Past the top level's reach the timer is parked and cascaded down again
+void test_long_timeout(void)
+{
+    probe_t probe;
+    const uint32_t timeout = 40u * 60u * 1000000u;
+
+    my_twheel_setup(&(probe.timer), probe_fire, &probe);
+    probe_arm(&probe, timeout);
+    run_for(timeout - TICK, TICK);
+    TEST_ASSERT_EQUAL_UINT32(0, probe.fired);
+    run_for(2 * TICK, TICK);
+    TEST_ASSERT_EQUAL_UINT32(1, probe.fired);
+    TEST_ASSERT_EQUAL_UINT32(probe.deadline, probe.fired_at);
+}
+
+//Random timeouts armed at random points between irregular my_twheel_tick() calls: never early, at most a tick late
+void test_random_never_early(void)
+{
+    static probe_t probes[200];
+    uint32_t early = 0;
+    uint32_t late = 0;
+    uint32_t fired = 0;
+
+    for (size_t i = 0; i < 200; i++) my_twheel_setup(&(probes[i].timer), probe_fire, &(probes[i]));
+    for (uint32_t round = 0; round < 20000; round++)
+    {
+        probe_t* probe = &(probes[rng() % 200]);
+        if (!my_twheel_is_armed(&(probe->timer))) probe_arm(probe, rng() % (200 * TICK));
+        host_clock_advance(rng() % (3 * TICK)); //Sometimes more than a tick passes unprocessed
+        if (rng() & 1u)
+        {
+            uint32_t before = get_micros_32();
+            my_twheel_tick();
+            for (size_t i = 0; i < 200; i++)
+            {
+                if (probes[i].fired)
+                {
+                    fired++;
+                    early += ((int32_t)(probes[i].fired_at - probes[i].deadline) < 0);
+                    probes[i].fired = 0;
+                }
+                //Still waiting a whole tick past its deadline
+                else if (my_twheel_is_armed(&(probes[i].timer)))
+                {
+                    late += ((int32_t)(before - probes[i].deadline) >= TICK);
+                }
+            }
+        }
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(1000, fired);
+    TEST_ASSERT_EQUAL_UINT32(0, early);
+    TEST_ASSERT_EQUAL_UINT32(0, late);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fires_once_on_time);
+    RUN_TEST(test_unprocessed_ticks_count);
+    RUN_TEST(test_cancel_and_rearm);
+    RUN_TEST(test_long_timeout);
+    RUN_TEST(test_random_never_early);
+    return UNITY_END();
+}
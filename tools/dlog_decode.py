@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""Render deferred log records (MY_DLOG_ENABLE builds) from a UART capture.
+
+Usage: dlog_decode.py capture.bin --elf .pio/build/mik32v2/firmware.elf [--text] [--categories SHELL,...]
+       dlog_decode.py capture.bin --table .pio/build/mik32v2/firmware.dlog
+
+Format strings are read from the .dlog_fmt section of the ELF (or from the table that post.py
+extracts next to it). %s arguments are looked up in the loaded sections of the ELF, so they only
+resolve with --elf and only for strings that live in the firmware image.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+FRAME_LOG = 0x02
+LEVEL_ERR = 0xFE
+LEVEL_DBG = 0xFD
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+SPEC = re.compile(r"%([-+ #0]*(?:\d+|\*)?(?:\.\d+)?)(hh|h|ll|l|L|z|j|t)?([diouxXeEfgGcsp%])")
+WIDE = ("ll", "j")  # 64-bit on the target, sent as two words (low first); everything else is one
+
+
+def xcrc32(data):
+    """Same as xcrc32() in src/nvs.c: MSB-first, poly 0x04C11DB7, init 0xFFFFFFFF, no final XOR."""
+    crc = 0xFFFFFFFF
+    for b in data:
+        crc ^= b << 24
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x04C11DB7) if crc & 0x80000000 else (crc << 1)
+            crc &= 0xFFFFFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            return None
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Image:
+    """Format table plus (optionally) the loaded sections of an ELF32 little-endian image."""
+
+    def __init__(self, fmt_table, sections=()):
+        self.fmt_table = fmt_table
+        self.sections = sections
+
+    @classmethod
+    def from_elf(cls, path):
+        with open(path, "rb") as f:
+            elf = f.read()
+        if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+            sys.exit("Expected a 32-bit little-endian ELF: " + path)
+        shoff, = struct.unpack_from("<I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+        headers = [struct.unpack_from("<IIIIIIIIII", elf, shoff + i * shentsize) for i in range(shnum)]
+        strtab = headers[shstrndx]
+        def name(h):
+            start = strtab[4] + h[0]
+            return elf[start:elf.index(b"\0", start)].decode()
+        fmt_table = None
+        sections = []
+        for h in headers:
+            _, sh_type, flags, addr, offset, size = h[:6]
+            if name(h) == ".dlog_fmt":
+                fmt_table = elf[offset:offset + size]
+            elif (flags & SHF_ALLOC) and sh_type != SHT_NOBITS:
+                sections.append((addr, elf[offset:offset + size]))
+        if fmt_table is None:
+            sys.exit("No .dlog_fmt section, was the firmware built with MY_DLOG_ENABLE=1?")
+        return cls(fmt_table, sections)
+
+    @staticmethod
+    def c_string(data, offset):
+        end = data.find(b"\0", offset)
+        return data[offset:end if end >= 0 else len(data)].decode(errors="replace")
+
+    def fmt(self, index):
+        if index >= len(self.fmt_table):
+            return "<unknown format %d>" % index
+        return self.c_string(self.fmt_table, index)
+
+    def string_at(self, addr):
+        for base, data in self.sections:
+            if base <= addr < base + len(data):
+                return self.c_string(data, addr - base)
+        return "<str@0x%08X>" % addr
+
+
+def render(fmt, args, image):
+    args = list(args)
+    def repl(m):
+        flags, length, conv = m.group(1), m.group(2), m.group(3)
+        bits = 64 if length in WIDE and conv in "diouxX" else 32
+        if conv == "%":
+            return "%"
+        if len(args) < bits // 32:
+            return m.group(0)
+        raw = args.pop(0)
+        if bits == 64:
+            raw |= args.pop(0) << 32
+        if conv in "di":
+            value = raw - (1 << bits) if raw >> (bits - 1) else raw
+        elif conv in "eEfgG":
+            value = struct.unpack("<f", struct.pack("<I", raw))[0]
+        elif conv == "c":
+            value = chr(raw & 0xFF)
+        elif conv == "s":
+            value = image.string_at(raw)
+        elif conv == "p":
+            conv, value = "X", raw
+        else:
+            value = raw
+        return ("%" + flags + conv) % value
+    return SPEC.sub(repl, fmt)
+
+
+def records(payload):
+    words = struct.unpack("<%dI" % (len(payload) // 4), payload[:len(payload) // 4 * 4])
+    i = 0
+    while i + 2 <= len(words):
+        header, time_us = words[i], words[i + 1]
+        count = header >> 24
+        yield header & 0xFFFF, (header >> 16) & 0xFF, time_us, words[i + 2:i + 2 + count]
+        i += 2 + count
+
+
+def level_prefix(level, categories):
+    if level == LEVEL_ERR:
+        return "[ERROR] "
+    if level == LEVEL_DBG:
+        return "[Debug] "
+    return "[%s]: " % (categories[level] if level < len(categories) else "CAT%d" % level)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--elf")
+    source.add_argument("--table", help=".dlog_fmt contents extracted by post.py")
+    parser.add_argument("--categories", default="SHELL", help="cli_logs_names, comma separated")
+    parser.add_argument("--text", action="store_true", help="also print the shell text around the frames")
+    args = parser.parse_args()
+
+    if args.elf:
+        image = Image.from_elf(args.elf)
+    else:
+        with open(args.table, "rb") as f:
+            image = Image(f.read())
+    categories = args.categories.split(",")
+    with open(args.capture, "rb") as f:
+        data = f.read()
+
+    dropped = 0
+    for chunk in data.split(b"\0"):
+        frame = cobs_decode(chunk) if chunk else None
+        if not frame or len(frame) < 8 or xcrc32(frame[:-4]) != struct.unpack_from("<I", frame, len(frame) - 4)[0]:
+            if args.text and chunk:
+                sys.stdout.write(chunk.decode(errors="replace"))
+            continue
+        if frame[0] != FRAME_LOG:
+            continue
+        lost, = struct.unpack_from("<H", frame, 2)
+        if lost:
+            dropped += lost
+            print("... %d record(s) dropped on the device" % lost)
+        for index, level, time_us, values in records(frame[4:-4]):
+            text = render(image.fmt(index), values, image)
+            print("%10.6f %s%s" % (time_us / 1e6, level_prefix(level, categories), text.rstrip("\n")))
+    if dropped:
+        print("%d record(s) dropped in total" % dropped, file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Linked code size of the console's number parsing: sscanf() against src/my_parse.c.
+
+Usage: parse_size.py [--cc riscv-none-elf-gcc] [--cflags "..."]
+
+Links two minimal programs that parse a float and a u32 from a string, one with sscanf("%f"/"%lu"),
+one with my_parse_float()/my_parse_u32(), and prints their text/data/bss and the difference.
+Without --cc the first RISC-V gcc found on PATH (or in ~/.platformio/packages) is used with the
+firmware's flags; with none found it falls back to a static host build, which only shows the trend.
+"""
+
+import argparse
+import glob
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+RISCV_CCS = ["riscv-none-elf-gcc", "riscv64-unknown-elf-gcc", "riscv-none-embed-gcc", "riscv32-unknown-elf-gcc"]
+RISCV_CFLAGS = "-march=rv32imc_zicsr -mabi=ilp32 -O2 --specs=nosys.specs"
+HOST_CFLAGS = "-O2 -static"
+
+PROGRAMS = {
+    "sscanf": r"""
+#include <stdio.h>
+volatile float f;
+volatile unsigned long u;
+int main(int argc, char** argv)
+{
+    float x = 0.0f;
+    unsigned long y = 0;
+    sscanf(argv[argc - 1], "%f", &x);
+    sscanf(argv[argc - 1], "%lu", &y);
+    f = x;
+    u = y;
+    return 0;
+}
+""",
+    "my_parse": r"""
+#include "my_parse.h"
+volatile float f;
+volatile unsigned long u;
+int main(int argc, char** argv)
+{
+    float x = 0.0f;
+    uint32_t y = 0;
+    my_parse_float(argv[argc - 1], &x);
+    my_parse_u32(argv[argc - 1], &y);
+    f = x;
+    u = y;
+    return 0;
+}
+""",
+}
+
+
+def find_cc():
+    for cc in RISCV_CCS:
+        if shutil.which(cc):
+            return cc, RISCV_CFLAGS
+    for cc in RISCV_CCS:
+        found = glob.glob(os.path.expanduser("~/.platformio/packages/*/bin/" + cc))
+        if found:
+            return found[0], RISCV_CFLAGS
+    return "gcc", HOST_CFLAGS
+
+
+def size_tool(cc):
+    return cc[: -len("gcc")] + "size" if cc.endswith("gcc") else "size"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--cc", help="compiler driver, default: a RISC-V gcc if one is found")
+    parser.add_argument("--cflags", help="flags for compiling and linking, default: the firmware's")
+    args = parser.parse_args()
+
+    cc, cflags = find_cc()
+    if args.cc:
+        cc = args.cc
+        cflags = RISCV_CFLAGS if "riscv" in os.path.basename(cc) else HOST_CFLAGS
+    if args.cflags is not None:
+        cflags = args.cflags
+    src = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src")
+
+    print(f"{cc} {cflags}")
+    sizes = {}
+    with tempfile.TemporaryDirectory() as tmp:
+        for name, code in PROGRAMS.items():
+            main_c = os.path.join(tmp, name + ".c")
+            elf = os.path.join(tmp, name + ".elf")
+            with open(main_c, "w") as f:
+                f.write(code)
+            sources = [main_c] + ([os.path.join(src, "my_parse.c")] if name == "my_parse" else [])
+            subprocess.run([cc] + cflags.split() + ["-I", src, "-o", elf] + sources + ["-lm"], check=True)
+            out = subprocess.run([size_tool(cc), elf], check=True, capture_output=True, text=True).stdout
+            text, data, bss = (int(v) for v in out.splitlines()[1].split()[:3])
+            sizes[name] = (text, data, bss)
+            print(f"{name:<10} text {text:8}  data {data:6}  bss {bss:6}")
+    delta = sizes["sscanf"][0] - sizes["my_parse"][0]
+    print(f"sscanf costs {delta} more bytes of text than my_parse")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,271 @@
+// Decode the binary telemetry stream ("telem on") into CSV.
+//
+// Build: g++ -std=c++17 -O2 -o telem_decode tools/telem_decode.cpp
+// Usage: telem_decode [-i capture.bin|-] [-o samples.csv|-] [--wide] [--text] [--channels src/my_telem.h]
+//
+// The input is the raw UART stream, shell text and frames mixed. Frames are COBS-encoded and
+// delimited by 0x00, anything that doesn't decode with a valid CRC is treated as text
+// (echoed to stderr with --text). Default output is one row per sample (time_us,channel,value),
+// --wide writes one column per channel instead, rows keyed by timestamp.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint8_t kFrameSamples = 0x01;
+constexpr size_t kHeaderLen = 4;
+constexpr size_t kSampleLen = 12;
+constexpr size_t kCrcLen = 4;
+
+enum SampleType : uint8_t { kU32 = 0, kI32, kF32 };
+
+struct Channel {
+    std::string name;
+};
+
+struct Sample {
+    uint32_t time_us;
+    uint8_t channel;
+    uint8_t type;
+    uint32_t raw;
+};
+
+struct Stats {
+    uint64_t frames = 0;
+    uint64_t bad_frames = 0;
+    uint64_t other_frames = 0;
+    uint64_t lost_frames = 0;
+    uint64_t dropped_samples = 0;
+    uint64_t samples = 0;
+};
+
+// Same CRC as xcrc32() in src/nvs.c: CRC-32 MSB-first, poly 0x04C11DB7, init 0xFFFFFFFF, no final XOR
+uint32_t xcrc32(const uint8_t* buf, size_t len) {
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i << 24;
+            for (int j = 0; j < 8; j++) c = (c & 0x80000000u) ? (c << 1) ^ 0x04C11DB7u : (c << 1);
+            table[i] = c;
+        }
+        ready = true;
+    }
+    uint32_t crc = 0xFFFFFFFFu;
+    while (len--) crc = (crc << 8) ^ table[((crc >> 24) ^ *buf++) & 0xFF];
+    return crc;
+}
+
+bool cobs_decode(const std::vector<uint8_t>& in, std::vector<uint8_t>& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < in.size()) {
+        uint8_t code = in[i++];
+        if (code == 0) return false;
+        for (uint8_t j = 1; j < code; j++) {
+            if (i >= in.size()) return false;
+            out.push_back(in[i++]);
+        }
+        if (code != 0xFF && i < in.size()) out.push_back(0);
+    }
+    return true;
+}
+
+uint32_t get_u32(const uint8_t* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+std::vector<Channel> load_channels(const std::string& path) {
+    std::vector<Channel> channels;
+    std::ifstream f(path);
+    if (!f) return channels;
+    std::stringstream ss;
+    ss << f.rdbuf();
+    std::string text = ss.str();
+    std::smatch block;
+    if (!std::regex_search(text, block, std::regex(R"(#define MY_TELEM_CHANNELS((?:.*\\\n)*.*\n))"))) return channels;
+    std::string body = block[1];
+    std::regex entry(R"(X\((\w+),\s*(\w+)\))");
+    for (auto it = std::sregex_iterator(body.begin(), body.end(), entry); it != std::sregex_iterator(); ++it) {
+        channels.push_back({(*it)[1]});
+    }
+    return channels;
+}
+
+std::string format_value(uint8_t type, uint32_t raw) {
+    char buf[32];
+    switch (type) {
+    case kI32:
+        std::snprintf(buf, sizeof(buf), "%d", int32_t(raw));
+        break;
+    case kF32: {
+        float f;
+        std::memcpy(&f, &raw, sizeof(f));
+        std::snprintf(buf, sizeof(buf), "%.9g", f);
+        break;
+    }
+    default:
+        std::snprintf(buf, sizeof(buf), "%u", raw);
+        break;
+    }
+    return buf;
+}
+
+class Decoder {
+public:
+    explicit Decoder(bool echo_text) : echo_text_(echo_text) {}
+
+    // Feed one 0x00-delimited chunk, returns the samples it carried (none for text)
+    void chunk(const std::vector<uint8_t>& raw, std::vector<Sample>& samples) {
+        if (raw.empty()) return;
+        std::vector<uint8_t> frame;
+        if (!cobs_decode(raw, frame) || frame.size() < kHeaderLen + kCrcLen ||
+            xcrc32(frame.data(), frame.size() - kCrcLen) != get_u32(&frame[frame.size() - kCrcLen])) {
+            // Shell text, or a frame that got mangled
+            if (looks_binary(raw)) stats.bad_frames++;
+            else if (echo_text_) std::cerr.write(reinterpret_cast<const char*>(raw.data()), raw.size());
+            return;
+        }
+        uint8_t seq = frame[1];
+        if (have_seq_) stats.lost_frames += uint8_t(seq - last_seq_ - 1);
+        have_seq_ = true;
+        last_seq_ = seq;
+        stats.frames++;
+        if (frame[0] != kFrameSamples || (frame.size() - kHeaderLen - kCrcLen) % kSampleLen != 0) {
+            stats.other_frames++;  // Deferred log and trace dumps, see tools/dlog_decode.py and trace2json.py
+            return;
+        }
+        stats.dropped_samples += frame[2] | (frame[3] << 8);
+        for (size_t off = kHeaderLen; off + kCrcLen < frame.size(); off += kSampleLen) {
+            const uint8_t* p = &frame[off];
+            samples.push_back({get_u32(p), p[4], p[5], get_u32(p + 8)});
+            stats.samples++;
+        }
+    }
+
+    Stats stats;
+
+private:
+    static bool looks_binary(const std::vector<uint8_t>& raw) {
+        for (uint8_t c : raw) {
+            if (c < 0x20 && c != '\n' && c != '\r' && c != '\t' && c != 0x1B) return true;
+        }
+        return false;
+    }
+
+    bool echo_text_;
+    bool have_seq_ = false;
+    uint8_t last_seq_ = 0;
+};
+
+void usage() {
+    std::cerr << "Usage: telem_decode [-i capture.bin|-] [-o samples.csv|-] [--wide] [--text] "
+                 "[--channels src/my_telem.h]\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string input = "-";
+    std::string output = "-";
+    std::string channels_path = "src/my_telem.h";
+    bool wide = false;
+    bool echo_text = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "-i" || arg == "-o" || arg == "--channels") && i + 1 < argc) {
+            (arg == "-i" ? input : arg == "-o" ? output : channels_path) = argv[++i];
+        } else if (arg == "--wide") {
+            wide = true;
+        } else if (arg == "--text") {
+            echo_text = true;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::ifstream in_file;
+    if (input != "-") {
+        in_file.open(input, std::ios::binary);
+        if (!in_file) {
+            std::cerr << "Can't open " << input << "\n";
+            return 1;
+        }
+    }
+    std::istream& in = input == "-" ? std::cin : in_file;
+    std::ofstream out_file;
+    if (output != "-") {
+        out_file.open(output);
+        if (!out_file) {
+            std::cerr << "Can't open " << output << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = output == "-" ? std::cout : out_file;
+
+    std::vector<Channel> channels = load_channels(channels_path);
+    auto channel_name = [&](uint8_t ch) {
+        return ch < channels.size() ? channels[ch].name : "CH" + std::to_string(ch);
+    };
+
+    Decoder decoder(echo_text);
+    std::vector<Sample> samples;
+    std::vector<uint8_t> chunk;
+    char c;
+    if (!wide) out << "time_us,channel,value\n";
+    while (in.get(c)) {
+        if (c != 0) {
+            chunk.push_back(uint8_t(c));
+            continue;
+        }
+        decoder.chunk(chunk, samples);
+        chunk.clear();
+        if (!wide) {
+            for (const Sample& s : samples) {
+                out << s.time_us << ',' << channel_name(s.channel) << ',' << format_value(s.type, s.raw) << '\n';
+            }
+            samples.clear();
+        }
+    }
+    decoder.chunk(chunk, samples);
+
+    if (wide) {
+        // Columnar layout: one column per channel seen, one row per timestamp
+        std::map<uint8_t, size_t> columns;
+        for (const Sample& s : samples) columns.emplace(s.channel, 0);
+        size_t index = 0;
+        out << "time_us";
+        for (auto& col : columns) {
+            col.second = index++;
+            out << ',' << channel_name(col.first);
+        }
+        out << '\n';
+        std::vector<std::pair<uint32_t, std::vector<std::string>>> rows;
+        for (const Sample& s : samples) {
+            if (rows.empty() || rows.back().first != s.time_us) {
+                rows.emplace_back(s.time_us, std::vector<std::string>(columns.size()));
+            }
+            rows.back().second[columns[s.channel]] = format_value(s.type, s.raw);
+        }
+        for (const auto& row : rows) {
+            out << row.first;
+            for (const auto& v : row.second) out << ',' << v;
+            out << '\n';
+        }
+    }
+
+    const Stats& st = decoder.stats;
+    std::cerr << "frames: " << st.frames << " (" << st.other_frames << " not samples), samples: " << st.samples << ", bad frames: " << st.bad_frames
+              << ", lost frames: " << st.lost_frames << ", dropped on device: " << st.dropped_samples << "\n";
+    return 0;
+}
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Convert a "trace_dump" capture into Chrome/Perfetto trace JSON.
+
+Usage: trace2json.py capture.bin [-o trace.json] [--events src/my_trace.h]
+
+The dump arrives as COBS telemetry frames (type 0x03, see src/my_trace.c) between the shell text;
+the last complete dump in the capture is converted.
+Open the result in chrome://tracing or https://ui.perfetto.dev
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+from dlog_decode import cobs_decode, xcrc32
+
+FRAME_TRACE = 0x03
+FLAG_BEGIN = 0x8000
+FLAG_END = 0x4000
+ID_MASK = 0x3FFF
+CONTEXT_TIDS = {"MAIN": 0, "ISR": 1}
+
+
+def load_events(header_path):
+    with open(header_path) as f:
+        text = f.read()
+    block = re.search(r"#define MY_TRACE_EVENTS((?:.*\\\n)*.*\n)", text)
+    if not block:
+        sys.exit("MY_TRACE_EVENTS not found in " + header_path)
+    return re.findall(r"X\((\w+),\s*(\w+)\)", block.group(1))
+
+
+def parse_dump(data):
+    dump = None
+    complete = None
+    for chunk in data.split(b"\0"):
+        frame = cobs_decode(chunk) if chunk else None
+        if not frame or len(frame) < 16 or xcrc32(frame[:-4]) != struct.unpack_from("<I", frame, len(frame) - 4)[0]:
+            continue
+        if frame[0] != FRAME_TRACE:
+            continue
+        lost, = struct.unpack_from("<H", frame, 2)
+        hz, first, total = struct.unpack_from("<IHH", frame, 4)
+        payload = frame[12:-4]
+        if first == 0:
+            dump = {"hz": hz, "total": total, "lost": lost, "records": []}
+        elif dump is None or first != len(dump["records"]):
+            dump = None  # A frame of this dump went missing
+            continue
+        dump["records"] += [struct.unpack_from("<HHI", payload, i * 8) for i in range(len(payload) // 8)]
+        if len(dump["records"]) >= dump["total"]:
+            complete = dump
+            dump = None
+    if complete is None:
+        sys.exit("No complete trace dump in the capture")
+    if complete["lost"]:
+        print("%d older event(s) were overwritten before the dump" % complete["lost"], file=sys.stderr)
+    return complete["hz"], complete["records"][:complete["total"]]
+
+
+def convert(hz, records, events):
+    out = []
+    base = None
+    last = 0
+    wraps = 0
+    for event_id, arg, cycles in records:
+        # mcycle is sampled as 32 bits, unwrap it
+        if base is not None and cycles < last:
+            wraps += 1
+        last = cycles
+        absolute = cycles + (wraps << 32)
+        if base is None:
+            base = absolute
+        index = event_id & ID_MASK
+        name, context = events[index] if index < len(events) else ("EV_%d" % index, "MAIN")
+        item = {
+            "name": name,
+            "ts": (absolute - base) * 1e6 / hz,
+            "pid": 0,
+            "tid": CONTEXT_TIDS.get(context, 0),
+        }
+        if event_id & FLAG_BEGIN:
+            item["ph"] = "B"
+        elif event_id & FLAG_END:
+            item["ph"] = "E"
+        else:
+            item["ph"] = "i"
+            item["s"] = "t"
+            item["args"] = {"arg": arg}
+        out.append(item)
+    meta = [{"name": "thread_name", "ph": "M", "pid": 0, "tid": tid, "args": {"name": name}}
+            for name, tid in CONTEXT_TIDS.items()]
+    return {"traceEvents": meta + out, "displayTimeUnit": "ns"}
+
+
+def main():
+    default_header = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "my_trace.h")
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture")
+    parser.add_argument("-o", "--output", default="-")
+    parser.add_argument("--events", default=default_header)
+    args = parser.parse_args()
+
+    with open(args.capture, "rb") as f:
+        hz, records = parse_dump(f.read())
+    trace = convert(hz, records, load_events(args.events))
+    if args.output == "-":
+        json.dump(trace, sys.stdout)
+    else:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+
+
+if __name__ == "__main__":
+    main()